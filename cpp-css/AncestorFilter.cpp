@@ -0,0 +1,126 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <AncestorFilter.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+
+namespace css
+{
+
+  std::uint32_t AncestorFilter::HashOf(SimpleSelectorKind Kind, std::string_view Name)
+  {
+    std::uint32_t Hash = HashText(Name) ^ ( ( std::uint32_t )Kind * 0x9E3779B9u );
+    Hash ^= Hash >> 15;
+    Hash *= 0x85EBCA6Bu;
+    Hash ^= Hash >> 13;
+    return Hash ? Hash : 1;
+  }
+
+  AncestorHashes AncestorFilter::HashesOf(const Stylesheet &Sheet, std::uint32_t Selector)
+  {
+    AncestorHashes Hashes;
+    std::size_t Count = 0;
+
+    const SelectorRecord &Record = Sheet.Selectors[Selector];
+
+    /* Compound c - 1 is an ancestor of the subject exactly when the combinator between it
+       and compound c is a descendant or child combinator */
+    for (std::uint32_t c = Record.CompoundCount - 1; c > 0 && Count < 4; --c) {
+      const Combinator Left = Sheet.Compounds[Record.FirstCompound + c].LeftCombinator;
+      if (Left != Combinator::Descendant && Left != Combinator::Child)
+        continue;
+
+      const CompoundRecord &Ancestor = Sheet.Compounds[Record.FirstCompound + c - 1];
+      for (std::uint32_t s = Ancestor.FirstSimple; s < Ancestor.FirstSimple + Ancestor.SimpleCount && Count < 4; ++s) {
+        const SimpleSelectorRecord &Simple = Sheet.SimpleSelectors[s];
+        if (Simple.Kind == SimpleSelectorKind::Type || Simple.Kind == SimpleSelectorKind::ID || Simple.Kind == SimpleSelectorKind::Class)
+          Hashes.Hash[Count++] = HashOf(Simple.Kind, Sheet.TextOf(Simple.Name));
+      }
+    }
+
+    return Hashes;
+  }
+
+  void AncestorFilter::Add(std::uint32_t Hash)
+  {
+    for (std::uint32_t Key : { Hash & KeyMask, ( Hash >> KeyBits ) & KeyMask })
+      if (Counters[Key] != 0xFF)
+        ++Counters[Key];
+  }
+
+  void AncestorFilter::Remove(std::uint32_t Hash)
+  {
+    for (std::uint32_t Key : { Hash & KeyMask, ( Hash >> KeyBits ) & KeyMask })
+      if (Counters[Key] != 0xFF)
+        --Counters[Key];
+  }
+
+  void AncestorFilter::AddFrame()
+  {
+    for (std::size_t h = Frames.back(); h < Pushed.size(); ++h)
+      Add(Pushed[h]);
+  }
+
+  void AncestorFilter::Pop()
+  {
+    if (Frames.empty())
+      return;
+
+    for (std::size_t h = Frames.back(); h < Pushed.size(); ++h)
+      Remove(Pushed[h]);
+
+    Pushed.resize(Frames.back());
+    Frames.pop_back();
+  }
+
+  void AncestorFilter::Clear()
+  {
+    Counters.fill(0);
+    Pushed.clear();
+    Frames.clear();
+  }
+
+  bool AncestorFilter::Empty() const
+  {
+    return std::all_of(Counters.begin(), Counters.end(), [](std::uint8_t c) { return c == 0; });
+  }
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Stylesheet.h>
+#include <ElementTraits.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  AncestorFilter
+//   - A counting Bloom filter over the tags, ids and
+//     classes of the ancestors of the element being
+//     matched
+//   - Walk your tree top-down and Push() each element
+//     before visiting its children, Pop() after.  The
+//     filter then always holds exactly the ancestors of
+//     the element you are matching
+//   - Every selector has up to four AncestorHashes (the
+//     ids, classes and tags a matching element's ancestors
+//     must have).  If any of them isn't in the filter, the
+//     selector can't match and is rejected without walking
+//     up the tree.  A false positive only costs the walk
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  /* Zero-terminated; a selector with no ancestor requirements has Hash[0] == 0 */
+  struct AncestorHashes
+  {
+    std::uint32_t Hash[4] = { };
+  };
+
+  class AncestorFilter
+  {
+  public:
+
+    static constexpr std::uint32_t KeyBits = 12;
+    static constexpr std::uint32_t KeyMask = ( 1u << KeyBits ) - 1;
+
+    /* T is anything derived from Element, or with an ElementTraits specialization */
+    template <class T>
+    void Push(const T &Ancestor)
+    {
+      using Traits = ElementTraits<TraitsNodeType<T>>;
+
+      Frames.push_back(( std::uint32_t )Pushed.size());
+
+      Pushed.push_back(HashOf(SimpleSelectorKind::Type, Traits::Tag(Ancestor)));
+      const std::string_view Id = Traits::Id(Ancestor);
+      if (!Id.empty())
+        Pushed.push_back(HashOf(SimpleSelectorKind::ID, Id));
+      for (const auto &Class : Traits::Classes(Ancestor))
+        Pushed.push_back(HashOf(SimpleSelectorKind::Class, std::string_view(Class)));
+
+      AddFrame();
+    }
+
+    void Pop();
+    void Clear();
+
+    std::size_t Depth() const { return Frames.size(); }
+
+    /* True if every counter is back to zero; a counter that ever saturated never is */
+    bool Empty() const;
+
+    bool MightContain(std::uint32_t Hash) const
+    {
+      return Counters[Hash & KeyMask] != 0 && Counters[( Hash >> KeyBits ) & KeyMask] != 0;
+    }
+
+    /* False only if some required ancestor is certainly not in the filter */
+    bool MightMatch(const AncestorHashes &Required) const
+    {
+      for (std::uint32_t Hash : Required.Hash) {
+        if (Hash == 0)
+          return true;
+        if (!MightContain(Hash))
+          return false;
+      }
+      return true;
+    }
+
+    /* Tags, ids and classes with the same text hash differently.  Never returns 0 */
+    static std::uint32_t HashOf(SimpleSelectorKind Kind, std::string_view Name);
+
+    /* The tags, ids and classes a selector requires of the subject's ancestors,
+       taken from the compounds to the left of a descendant or child combinator */
+    static AncestorHashes HashesOf(const Stylesheet &Sheet, std::uint32_t Selector);
+
+  private:
+
+    void AddFrame();
+    void Add(std::uint32_t Hash);
+    void Remove(std::uint32_t Hash);
+
+    /* Saturated counters stay saturated; the filter can then report false positives
+       for that key, never false negatives */
+    std::array<std::uint8_t, 1u << KeyBits> Counters = { };
+    std::vector<std::uint32_t>              Pushed;
+    std::vector<std::uint32_t>              Frames;
+  };
+
+}
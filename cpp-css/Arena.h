@@ -0,0 +1,119 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <memory_resource>
+
+////////////////////////////////////////////////////////////
+//  Arenas
+//   - Stylesheet and the *View types allocate through a
+//     std::pmr::memory_resource.  Hand them a ParseArena's
+//     resource and every table, string and vector they
+//     create comes out of one bump allocator and is freed
+//     in one go when the arena is released or destroyed
+//   - Anything parsed into an arena must not outlive it
+//   - AllocationCounter wraps another resource and counts
+//     what goes through it.  A ParseArena counts the
+//     blocks it had to get from the heap, so
+//     Arena.Upstream().Allocations() is the number of
+//     mallocs a parse really made
+//
+//     css::ParseArena Arena;
+//     css::Stylesheet Sheet(Arena.Resource());
+//     Sheet.Parse(Source);
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  class AllocationCounter : public std::pmr::memory_resource
+  {
+  public:
+
+    explicit AllocationCounter(std::pmr::memory_resource *UpstreamResource = std::pmr::new_delete_resource())
+      : Upstream(UpstreamResource) { }
+
+    std::size_t Allocations() const { return AllocationCount; }
+    std::size_t Deallocations() const { return DeallocationCount; }
+    std::size_t BytesAllocated() const { return ByteCount; }
+
+    void Reset();
+
+  private:
+
+    void *do_allocate(std::size_t Bytes, std::size_t Alignment) override;
+    void do_deallocate(void *Memory, std::size_t Bytes, std::size_t Alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &Other) const noexcept override;
+
+    std::pmr::memory_resource *Upstream;
+    std::size_t AllocationCount = 0;
+    std::size_t DeallocationCount = 0;
+    std::size_t ByteCount = 0;
+  };
+
+  class ParseArena
+  {
+  public:
+
+    explicit ParseArena(std::size_t InitialSize = 64 * 1024)
+      : Buffer(InitialSize, &Counter) { }
+
+    ParseArena(const ParseArena &) = delete;
+    ParseArena &operator=(const ParseArena &) = delete;
+
+    std::pmr::memory_resource *Resource() { return &Buffer; }
+
+    /* Frees everything allocated from the arena at once */
+    void Release() { Buffer.release(); }
+
+    const AllocationCounter &Upstream() const { return Counter; }
+
+  private:
+
+    AllocationCounter Counter;
+    std::pmr::monotonic_buffer_resource Buffer;
+  };
+
+}
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Atoms.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  AtomTable::AtomTable(std::pmr::memory_resource *Resource)
+    : Entries(Resource), Slots(Resource), Text(Resource)
+  {
+    Clear();
+  }
+
+  void AtomTable::Clear()
+  {
+    Entries.clear();
+    Entries.push_back({ 0, 0, HashText("") });
+    Slots.assign(64, NullAtom);
+    Text.clear();
+  }
+
+  /* Index of the slot holding Name, or of the empty slot it would go in */
+  std::size_t AtomTable::Probe(std::string_view Name, std::uint32_t Hash) const
+  {
+    const std::size_t Mask = Slots.size() - 1;
+    std::size_t Slot = Hash & Mask;
+
+    while (Slots[Slot] != NullAtom) {
+      const Entry &Existing = Entries[Slots[Slot]];
+      if (Existing.Hash == Hash && TextOf(Slots[Slot]) == Name)
+        return Slot;
+      Slot = ( Slot + 1 ) & Mask;
+    }
+
+    return Slot;
+  }
+
+  Atom AtomTable::Intern(std::string_view Name)
+  {
+    if (Name.empty())
+      return NullAtom;
+
+    const std::uint32_t Hash = HashText(Name);
+    std::size_t Slot = Probe(Name, Hash);
+
+    if (Slots[Slot] != NullAtom)
+      return Slots[Slot];
+
+    const Atom Added = ( Atom )Entries.size();
+    Entries.push_back({ ( std::uint32_t )Text.size(), ( std::uint32_t )Name.size(), Hash });
+    Text.append(Name.data(), Name.size());
+    Slots[Slot] = Added;
+
+    /* Keep the table at most half full so probe chains stay short */
+    if (Entries.size() * 2 > Slots.size())
+      Grow();
+
+    return Added;
+  }
+
+  Atom AtomTable::Find(std::string_view Name) const
+  {
+    if (Name.empty())
+      return NullAtom;
+
+    return Slots[Probe(Name, HashText(Name))];
+  }
+
+  /* Atoms go into the slots in order, here and in Grow, so no probe chain of an older atom
+     passes through a newer one's slot.  Emptying the newest slots first leaves every chain
+     that remains intact */
+  void AtomTable::Truncate(std::size_t Count)
+  {
+    if (Count == 0 || Count >= Entries.size())
+      return;
+
+    for (Atom Handle = ( Atom )Entries.size() - 1; Handle >= ( Atom )Count; --Handle)
+      Slots[Probe(TextOf(Handle), Entries[Handle].Hash)] = NullAtom;
+
+    Text.resize(Entries[Count].Offset);
+    Entries.resize(Count);
+  }
+
+  void AtomTable::Grow()
+  {
+    const std::size_t Mask = Slots.size() * 2 - 1;
+    Slots.assign(Slots.size() * 2, NullAtom);
+
+    for (Atom Handle = 1; Handle < ( Atom )Entries.size(); ++Handle) {
+      std::size_t Slot = Entries[Handle].Hash & Mask;
+      while (Slots[Slot] != NullAtom)
+        Slot = ( Slot + 1 ) & Mask;
+      Slots[Slot] = Handle;
+    }
+  }
+
+}
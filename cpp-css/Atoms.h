@@ -0,0 +1,128 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  Atoms
+//   - An atom is a small integer standing in for an
+//     interned identifier (a type, class, id, attribute
+//     or property name)
+//   - Within one AtomTable equal text always gets the same
+//     atom, so comparing two names is comparing two ints,
+//     and each distinct name is stored exactly once
+//   - Atoms are handed out densely in the order the names
+//     are first seen.  Atom 0 (NullAtom) is the empty
+//     string, and is what Find() returns for a name the
+//     table has never seen - so it never equals the atom
+//     of a real name
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  using Atom = std::uint32_t;
+
+  constexpr Atom NullAtom = 0;
+
+  /* FNV-1a */
+  __forceinline std::uint32_t HashText(std::string_view Text)
+  {
+    std::uint32_t Hash = 2166136261u;
+    for (char c : Text) {
+      Hash ^= ( unsigned char )c;
+      Hash *= 16777619u;
+    }
+    return Hash;
+  }
+
+  class AtomTable
+  {
+  public:
+
+    explicit AtomTable(std::pmr::memory_resource *Resource = std::pmr::get_default_resource());
+
+    /* Returns the atom for Text, adding it if it's new */
+    Atom Intern(std::string_view Text);
+
+    /* Returns the atom for Text, or NullAtom if it has never been interned */
+    Atom Find(std::string_view Text) const;
+
+    std::string_view TextOf(Atom Handle) const
+    {
+      const Entry &Found = Entries[Handle];
+      return std::string_view(Text.data() + Found.Offset, Found.Length);
+    }
+
+    /* Number of atoms, counting NullAtom */
+    std::size_t Size() const { return Entries.size(); }
+
+    void Clear();
+
+    /* Forgets the atoms from Count on, as if they had never been interned */
+    void Truncate(std::size_t Count);
+
+  private:
+
+    struct Entry
+    {
+      std::uint32_t Offset;
+      std::uint32_t Length;
+      std::uint32_t Hash;
+    };
+
+    std::size_t Probe(std::string_view Name, std::uint32_t Hash) const;
+    void Grow();
+
+    std::pmr::vector<Entry> Entries;
+    std::pmr::vector<Atom>  Slots;   // open addressing, power of two sized, NullAtom marks an empty slot
+    std::pmr::string        Text;
+  };
+
+}
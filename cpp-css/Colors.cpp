@@ -0,0 +1,255 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Colors.h>
+#include <Units.h>
+#include <Scanner.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cmath>
+
+namespace css
+{
+
+  namespace
+  {
+
+    constexpr std::uint8_t NotHex = 0xF0;
+
+    constexpr std::array<std::uint8_t, 256> BuildHexValues()
+    {
+      std::array<std::uint8_t, 256> Values = { };
+      for (auto &Value : Values)
+        Value = NotHex;
+      for (int c = 0; c < 10; ++c)
+        Values['0' + c] = ( std::uint8_t )c;
+      for (int c = 0; c < 6; ++c)
+        Values['a' + c] = Values['A' + c] = ( std::uint8_t )( 10 + c );
+      return Values;
+    }
+
+    constexpr std::array<std::uint8_t, 256> HexValues = BuildHexValues();
+
+    std::uint8_t Channel(float Value)
+    {
+      if (!( Value > 0.0f ))
+        return 0;
+      return Value >= 255.0f ? 255 : ( std::uint8_t )std::lround(Value);
+    }
+
+    void SkipWhitespace(const char *&Pos, const char *End)
+    {
+      while (Pos != End && IsWhitespaceByte(( unsigned char )*Pos))
+        ++Pos;
+    }
+
+    /* Hue in degrees, from a bare number or one with an angle unit */
+    bool ScanHue(const char *&Pos, const char *End, float &Degrees)
+    {
+      const char *Unit = ScanNumber(Pos, End, Degrees);
+      if (Unit == Pos)
+        return false;
+
+      const char *After = Unit;
+      while (After != End && IsNameByte(( unsigned char )*After))
+        ++After;
+
+      const std::string_view Name(Unit, ( std::size_t )( After - Unit ));
+      if (Name.empty() || Detail::EqualsFoldingCase(Name, "deg"))
+        ;
+      else if (Detail::EqualsFoldingCase(Name, "turn"))
+        Degrees *= 360.0f;
+      else if (Detail::EqualsFoldingCase(Name, "rad"))
+        Degrees *= 57.2957795f;
+      else if (Detail::EqualsFoldingCase(Name, "grad"))
+        Degrees *= 0.9f;
+      else
+        return false;
+
+      Pos = After;
+      return true;
+    }
+
+    /* CSS Color 4's hsl-to-rgb; Saturation and Lightness are 0-1 */
+    std::uint32_t HslToRgb(float Hue, float Saturation, float Lightness, std::uint8_t Alpha)
+    {
+      Hue = std::fmod(Hue, 360.0f);
+      if (Hue < 0.0f)
+        Hue += 360.0f;
+
+      const float Chroma = Saturation * std::fmin(Lightness, 1.0f - Lightness);
+      auto Part = [&](float n) {
+        const float k = std::fmod(n + Hue / 30.0f, 12.0f);
+        return Lightness - Chroma * std::fmax(-1.0f, std::fmin(std::fmin(k - 3.0f, 9.0f - k), 1.0f));
+      };
+
+      return PackColor(Channel(Part(0.0f) * 255.0f), Channel(Part(8.0f) * 255.0f), Channel(Part(4.0f) * 255.0f), Alpha);
+    }
+
+    /* rgb(), rgba(), hsl() and hsla(), from just after the '(' */
+    bool ParseColorFunction(const char *&Pos, const char *End, bool Hsl, std::uint32_t &Color)
+    {
+      float Components[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+      bool  Percent[4] = { false, false, false, false };
+      std::size_t Count = 0;
+
+      SkipWhitespace(Pos, End);
+      while (Count < 4 && Pos != End && *Pos != ')') {
+        /* Commas, whitespace or (before alpha) a slash - the old and new forms are both accepted */
+        if (Count > 0 && ( *Pos == ',' || *Pos == '/' )) {
+          ++Pos;
+          SkipWhitespace(Pos, End);
+        }
+
+        if (Hsl && Count == 0) {
+          if (!ScanHue(Pos, End, Components[0]))
+            return false;
+        }
+        else {
+          const char *After = ScanNumber(Pos, End, Components[Count]);
+          if (After == Pos)
+            return false;
+          Pos = After;
+          if (Pos != End && *Pos == '%') {
+            Percent[Count] = true;
+            ++Pos;
+          }
+        }
+
+        ++Count;
+        SkipWhitespace(Pos, End);
+      }
+
+      if (Count < 3 || Pos == End || *Pos != ')')
+        return false;
+      ++Pos;
+
+      const float AlphaValue = Percent[3] ? Components[3] / 100.0f : Components[3];
+      const std::uint8_t Alpha = Channel(AlphaValue * 255.0f);
+
+      if (Hsl) {
+        auto Fraction = [](float Value) { return std::fmax(0.0f, std::fmin(Value / 100.0f, 1.0f)); };
+        Color = HslToRgb(Components[0], Fraction(Components[1]), Fraction(Components[2]), Alpha);
+        return true;
+      }
+
+      std::uint8_t Rgb[3];
+      for (std::size_t i = 0; i < 3; ++i)
+        Rgb[i] = Channel(Percent[i] ? Components[i] * 2.55f : Components[i]);
+
+      Color = PackColor(Rgb[0], Rgb[1], Rgb[2], Alpha);
+      return true;
+    }
+
+  }
+
+  bool DecodeHexColor(std::string_view Digits, std::uint32_t &Color)
+  {
+    const std::size_t Length = Digits.size();
+    if (Length != 3 && Length != 4 && Length != 6 && Length != 8)
+      return false;
+
+    /* Collect every digit before looking at any of them; a bad one sets a high bit */
+    std::uint8_t Nibbles[8];
+    std::uint8_t Bad = 0;
+    for (std::size_t i = 0; i < Length; ++i) {
+      Nibbles[i] = HexValues[( unsigned char )Digits[i]];
+      Bad |= Nibbles[i];
+    }
+
+    if (Bad & NotHex)
+      return false;
+
+    std::uint32_t Packed = 0;
+    if (Length <= 4) {
+      for (std::size_t i = 0; i < Length; ++i)
+        Packed = ( Packed << 8 ) | ( std::uint32_t )( Nibbles[i] * 17 );
+    }
+    else {
+      for (std::size_t i = 0; i < Length; i += 2)
+        Packed = ( Packed << 8 ) | ( std::uint32_t )( Nibbles[i] << 4 | Nibbles[i + 1] );
+    }
+
+    /* No alpha digits means opaque */
+    Color = ( Length == 3 || Length == 6 ) ? ( Packed << 8 | 0xFF ) : Packed;
+    return true;
+  }
+
+  std::size_t ParseColor(std::string_view Text, std::uint32_t &Color)
+  {
+    const char *First = Text.data(), *Pos = First, *End = First + Text.size();
+    if (Pos == End)
+      return 0;
+
+    if (*Pos == '#') {
+      const char *Digits = ++Pos;
+      while (Pos != End && IsNameByte(( unsigned char )*Pos))
+        ++Pos;
+
+      return DecodeHexColor(std::string_view(Digits, ( std::size_t )( Pos - Digits )), Color) ? ( std::size_t )( Pos - First ) : 0;
+    }
+
+    while (Pos != End && IsNameByte(( unsigned char )*Pos))
+      ++Pos;
+
+    const std::string_view Name(First, ( std::size_t )( Pos - First ));
+    if (Name.empty())
+      return 0;
+
+    if (Pos == End || *Pos != '(')
+      return LookupNamedColor(Name, Color) ? Name.size() : 0;
+
+    bool Hsl;
+    if (Detail::EqualsFoldingCase(Name, "rgb") || Detail::EqualsFoldingCase(Name, "rgba"))
+      Hsl = false;
+    else if (Detail::EqualsFoldingCase(Name, "hsl") || Detail::EqualsFoldingCase(Name, "hsla"))
+      Hsl = true;
+    else
+      return 0;
+
+    ++Pos;
+    std::uint32_t Parsed = 0;
+    if (!ParseColorFunction(Pos, End, Hsl, Parsed))
+      return 0;
+
+    Color = Parsed;
+    return ( std::size_t )( Pos - First );
+  }
+
+}
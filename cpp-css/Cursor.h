@@ -0,0 +1,357 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Scanner.h>
+#include <Diagnostics.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////
+//  Cursors
+//   - Every parser is written once against the small
+//     cursor interface below and instantiated for both
+//     kinds of input
+//   - BufferCursor walks a contiguous range of memory
+//     with a plain pointer.  Text it hands back is a
+//     std::string_view into that memory, so nothing is
+//     copied and the buffer must outlive the results
+//   - StreamCursor adapts a std::istream to the same
+//     interface.  While a checkpoint is held it remembers
+//     the characters it took from the stream, so it can
+//     hand them back as owned strings or put them back.
+//     Its checkpoints release themselves when they go out
+//     of scope, and once the outermost one does, what was
+//     remembered is dropped - memory follows the longest
+//     open checkpoint, not the whole input
+//   - Parsers are speculative: they Save() before they
+//     start and Rewind() on failure, so a failed attempt
+//     leaves the input exactly where it was.  Rewinding a
+//     BufferCursor is a pointer assignment; a StreamCursor
+//     seeks when the stream allows it and only falls back
+//     to putback() on streams that can't seek
+//
+//  Cursor interface
+//     Good()           - false if the source is unusable
+//     Peek()           - next character or eof(), not consumed
+//     Get()            - next character or eof(), consumed
+//     Ignore()         - consume one character
+//     Mark()           - remember the current position
+//     Slice(Mark)      - text consumed since Mark (taken
+//                        while a checkpoint is held)
+//     Save()           - checkpoint the current position
+//     Rewind(Saved)    - return to a checkpoint
+//     SkipWhitespace() - consume any run of whitespace
+//     SkipIdentifier() - consume any run of [A-Za-z0-9-]
+//     SkipUntil(Delim) - consume up to (not including) Delim
+//     SkipValue()      - consume a declaration value up to
+//                        (not including) the ; or } that
+//                        ends it; see ScanValue
+//     Offset()         - characters consumed so far
+//     Report(Code)     - hand a diagnostic at Offset() to the
+//                        attached sink, if any
+//
+//  Sinks
+//   - Both cursors are templates on the type of sink they
+//     report to.  BufferCursor and StreamCursor report to
+//     any DiagnosticSink; QuietBufferCursor and
+//     QuietStreamCursor are built on NullDiagnosticSink,
+//     so every Report compiles to nothing
+//   - SetStreamDiagnostics attaches a sink to a
+//     std::istream itself, so the istream overloads
+//     (Input >> Selector) report to it too
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  /* The sink attached to a stream with SetStreamDiagnostics, kept in the stream's pword storage */
+  inline int StreamDiagnosticsIndex()
+  {
+    static const int Index = std::ios_base::xalloc();
+    return Index;
+  }
+
+  inline void SetStreamDiagnostics(std::ios_base &Stream, DiagnosticSink *Sink) { Stream.pword(StreamDiagnosticsIndex()) = Sink; }
+  inline DiagnosticSink* StreamDiagnostics(std::ios_base &Stream) { return static_cast<DiagnosticSink *>(Stream.pword(StreamDiagnosticsIndex())); }
+
+  template <class SinkType = DiagnosticSink>
+  class BasicBufferCursor
+  {
+  public:
+
+    using TextType = std::string_view;
+    using Position = const char *;
+    using Checkpoint = const char *;
+
+    BasicBufferCursor() = default;
+    BasicBufferCursor(const char *First, const char *Last) : Begin(First), Pos(First), End(Last) { }
+    explicit BasicBufferCursor(std::string_view Source) : BasicBufferCursor(Source.data(), Source.data() + Source.size()) { }
+
+    bool Good() const { return Pos != nullptr; }
+    bool AtEnd() const { return Pos == End; }
+
+    int Peek() const { return Pos != End ? ( unsigned char )*Pos : std::char_traits<char>::eof(); }
+    int Get() { return Pos != End ? ( unsigned char )*Pos++ : std::char_traits<char>::eof(); }
+    void Ignore() { if (Pos != End) ++Pos; }
+    void Advance(std::size_t Count) { Pos = ( Count < ( std::size_t )( End - Pos ) ) ? Pos + Count : End; }
+
+    Position Mark() const { return Pos; }
+    TextType Slice(Position From) const { return TextType(From, ( std::size_t )( Pos - From )); }
+
+    Checkpoint Save() const { return Pos; }
+    void Rewind(Checkpoint Saved) { Pos = Saved; }
+
+    /* Most runs of whitespace are a single space, so don't pay for a scanner call unless there is a run */
+    void SkipWhitespace()
+    {
+      if (Pos != End && IsWhitespaceByte(( unsigned char )*Pos))
+        Pos = ScanWhitespace(Pos + 1, End);
+    }
+    void SkipIdentifier() { Pos = ScanIdentifier(Pos, End); }
+    void SkipUntil(char Delim) { Pos = ScanUntil(Pos, End, Delim); }
+    void SkipValue() { Pos = ScanValue(Pos, End); }
+
+    std::size_t Offset() const { return ( std::size_t )( Pos - Begin ); }
+    std::string_view Remaining() const { return std::string_view(Pos, ( std::size_t )( End - Pos )); }
+
+    SinkType *Diagnostics() const { return Sink; }
+    void SetDiagnostics(SinkType *Diagnostics) { Sink = Diagnostics; }
+    void Report(DiagnosticCode Code) const { Report(Code, Offset()); }
+    void Report(DiagnosticCode Code, std::size_t At) const
+    {
+#ifndef CSS_NO_DIAGNOSTICS
+      if constexpr (!std::is_same<SinkType, NullDiagnosticSink>::value) {
+        if (Sink)
+          Sink->Report({ Code, ( std::uint32_t )At });
+      }
+#endif
+    }
+
+  private:
+
+    const char *Begin = nullptr;
+    const char *Pos = nullptr;
+    const char *End = nullptr;
+    SinkType *Sink = nullptr;
+  };
+
+  template <class SinkType = DiagnosticSink>
+  class BasicStreamCursor
+  {
+  public:
+
+    using TextType = std::string;
+    using Position = std::size_t;
+
+    /* Move only; the cursor remembers characters for as long as any checkpoint is alive */
+    class Checkpoint
+    {
+    public:
+      Checkpoint(const Checkpoint &) = delete;
+      Checkpoint& operator=(const Checkpoint &) = delete;
+      Checkpoint(Checkpoint &&Other) noexcept : Owner(Other.Owner), Offset(Other.Offset), Stream(Other.Stream) { Other.Owner = nullptr; }
+      ~Checkpoint() { if (Owner) Owner->Release(); }
+
+    private:
+      friend class BasicStreamCursor;
+      Checkpoint(BasicStreamCursor &Owner, std::size_t Offset, std::streampos Stream) : Owner(&Owner), Offset(Offset), Stream(Stream) { }
+
+      BasicStreamCursor *Owner;
+      std::size_t    Offset;
+      std::streampos Stream;
+    };
+
+    /* Reports to the sink attached to Source (SetStreamDiagnostics), if any */
+    explicit BasicStreamCursor(std::istream &Source) : Input(Source)
+    {
+      if constexpr (std::is_same<SinkType, DiagnosticSink>::value)
+        Sink = StreamDiagnostics(Source);
+    }
+
+    BasicStreamCursor(const BasicStreamCursor &) = delete;
+    BasicStreamCursor& operator=(const BasicStreamCursor &) = delete;
+
+    bool Good() const { return static_cast<bool>(Input); }
+
+    /* Once the stream has hit its end, don't touch it again - that would also set failbit */
+    int Peek() { return Input.eof() ? std::char_traits<char>::eof() : Input.peek(); }
+    int Get()
+    {
+      if (Input.eof())
+        return std::char_traits<char>::eof();
+
+      int c = Input.get();
+      if (c != std::char_traits<char>::eof()) {
+        ++Consumed;
+        if (Held)
+          Recent += ( char )c;
+      }
+      return c;
+    }
+    void Ignore() { Get(); }
+
+    Position Mark() const { return Consumed; }
+    TextType Slice(Position From) const { return Recent.substr(From - RecentStart); }
+
+    /* tellg() on a stream at eof would set failbit, but nothing can be consumed past eof anyway */
+    Checkpoint Save()
+    {
+      if (Held++ == 0) {
+        Recent.clear();
+        RecentStart = Consumed;
+      }
+      return Checkpoint(*this, Consumed, Input.eof() ? std::streampos(-1) : Input.tellg());
+    }
+    void Rewind(const Checkpoint &Saved)
+    {
+      if (Saved.Offset == Consumed)
+        return;
+
+      if (Saved.Stream != std::streampos(-1)) {
+        Input.clear(Input.rdstate() & ~std::ios::eofbit);
+        if (Input.seekg(Saved.Stream)) {
+          Recent.resize(Saved.Offset - RecentStart);
+          Consumed = Saved.Offset;
+          return;
+        }
+        Input.clear(Input.rdstate() & ~std::ios::failbit);
+      }
+
+      while (Consumed > Saved.Offset) {
+        Input.putback(Recent.back());
+        Recent.pop_back();
+        --Consumed;
+      }
+    }
+
+    void SkipWhitespace() { while (IsWhitespaceByte(Peek())) Get(); }
+    void SkipIdentifier() { while (IsIdentifierByte(Peek())) Get(); }
+    void SkipUntil(char Delim)
+    {
+      int c = Peek();
+      while (c != std::char_traits<char>::eof() && c != Delim) {
+        Get();
+        c = Peek();
+      }
+    }
+
+    /* The same nesting rules as ScanValue, a character at a time */
+    void SkipValue()
+    {
+      int Depth = 0;
+      int Quote = 0;
+
+      for (int c = Peek(); c != std::char_traits<char>::eof(); Get(), c = Peek()) {
+        if (c == '\\') {
+          Get();
+          continue;
+        }
+
+        if (Quote) {
+          if (c == Quote || c == '\n')
+            Quote = 0;
+        }
+        else if (c == '"' || c == '\'') {
+          Quote = c;
+        }
+        else if (c == '(' || c == '[' || c == '{') {
+          ++Depth;
+        }
+        else if (c == ')' || c == ']') {
+          Depth -= Depth > 0;
+        }
+        else if (( c == ';' || c == '}' ) && Depth == 0) {
+          return;
+        }
+        else if (c == '}') {
+          --Depth;
+        }
+      }
+    }
+
+    std::size_t Offset() const { return Consumed; }
+
+    /* Characters kept for the checkpoints still held */
+    std::size_t Remembered() const { return Recent.size(); }
+
+    SinkType *Diagnostics() const { return Sink; }
+    void SetDiagnostics(SinkType *Diagnostics) { Sink = Diagnostics; }
+    void Report(DiagnosticCode Code) const { Report(Code, Offset()); }
+    void Report(DiagnosticCode Code, std::size_t At) const
+    {
+#ifndef CSS_NO_DIAGNOSTICS
+      if constexpr (!std::is_same<SinkType, NullDiagnosticSink>::value) {
+        if (Sink)
+          Sink->Report({ Code, ( std::uint32_t )At });
+      }
+#endif
+    }
+
+  private:
+
+    /* The outermost checkpoint is done with; nothing can be rewound to or sliced from before here */
+    void Release()
+    {
+      if (--Held == 0)
+        Recent.clear();
+    }
+
+    std::istream &Input;
+    std::size_t Consumed = 0;
+    std::size_t Held = 0;
+    std::size_t RecentStart = 0;
+    std::string Recent;
+    SinkType *Sink = nullptr;
+  };
+
+  using BufferCursor = BasicBufferCursor<>;
+  using StreamCursor = BasicStreamCursor<>;
+  using QuietBufferCursor = BasicBufferCursor<NullDiagnosticSink>;
+  using QuietStreamCursor = BasicStreamCursor<NullDiagnosticSink>;
+
+}
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <DeclarationCache.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  MatchedDeclarationsCache::MatchedDeclarationsCache(std::size_t Capacity)
+  {
+    std::size_t Rounded = 1;
+    while (Rounded < Capacity)
+      Rounded <<= 1;
+    Slots.resize(Rounded);
+  }
+
+  /* FNV-1a over the rule indices, then mixed so the low bits (which pick the slot)
+     depend on all of them */
+  std::uint64_t MatchedDeclarationsCache::HashOf(const std::vector<std::uint32_t> &Rules)
+  {
+    std::uint64_t Hash = 14695981039346656037ull;
+    for (std::uint32_t Rule : Rules) {
+      Hash ^= Rule;
+      Hash *= 1099511628211ull;
+    }
+
+    Hash ^= Hash >> 33;
+    Hash *= 0xFF51AFD7ED558CCDull;
+    Hash ^= Hash >> 33;
+    return Hash;
+  }
+
+  const std::vector<ResolvedProperty>* MatchedDeclarationsCache::Find(const std::vector<std::uint32_t> &Rules, std::uint64_t Hash)
+  {
+    const Slot &Entry = Slots[Hash & ( Slots.size() - 1 )];
+
+    if (Entry.Occupied && Entry.Hash == Hash && Entry.Rules == Rules) {
+      ++HitCount;
+      return &Entry.Style;
+    }
+
+    ++MissCount;
+    return nullptr;
+  }
+
+  void MatchedDeclarationsCache::Insert(const std::vector<std::uint32_t> &Rules, std::uint64_t Hash, const std::vector<ResolvedProperty> &Style)
+  {
+    Slot &Entry = Slots[Hash & ( Slots.size() - 1 )];
+
+    if (!Entry.Occupied)
+      ++Used;
+
+    Entry.Occupied = true;
+    Entry.Hash = Hash;
+    Entry.Rules.assign(Rules.begin(), Rules.end());
+    Entry.Style.assign(Style.begin(), Style.end());
+  }
+
+  void MatchedDeclarationsCache::Clear()
+  {
+    for (Slot &Entry : Slots)
+      Entry.Occupied = false;
+    Used = 0;
+    HitCount = MissCount = 0;
+  }
+
+}
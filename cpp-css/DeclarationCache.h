@@ -0,0 +1,111 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Atoms.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  MatchedDeclarationsCache
+//   - Remembers the cascaded style for a list of matched
+//     rules.  Two objects matching the same rules in the
+//     same order get the same style, whoever they are and
+//     wherever they are in the tree, so the second one
+//     skips the cascade and copies the first one's result
+//   - Keyed by a hash of the ordered rule list; the list
+//     itself is kept too, so a hash collision is a miss,
+//     never a wrong style
+//   - Direct-mapped with a fixed number of slots: a new
+//     entry replaces whatever was in its slot, and memory
+//     never grows past Capacity styles
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  /* One property of a resolved style, and the declaration that won it */
+  struct ResolvedProperty
+  {
+    Atom          Property = NullAtom;
+    std::uint32_t Declaration = 0;
+  };
+
+  class MatchedDeclarationsCache
+  {
+  public:
+
+    /* Capacity is rounded up to a power of two */
+    explicit MatchedDeclarationsCache(std::size_t Capacity = 256);
+
+    static std::uint64_t HashOf(const std::vector<std::uint32_t> &Rules);
+
+    /* nullptr on a miss */
+    const std::vector<ResolvedProperty>* Find(const std::vector<std::uint32_t> &Rules, std::uint64_t Hash);
+    void Insert(const std::vector<std::uint32_t> &Rules, std::uint64_t Hash, const std::vector<ResolvedProperty> &Style);
+
+    void Clear();
+
+    std::size_t Capacity() const { return Slots.size(); }
+    std::size_t Size() const { return Used; }
+    std::size_t Hits() const { return HitCount; }
+    std::size_t Misses() const { return MissCount; }
+
+  private:
+
+    struct Slot
+    {
+      bool                          Occupied = false;
+      std::uint64_t                 Hash = 0;
+      std::vector<std::uint32_t>    Rules;
+      std::vector<ResolvedProperty> Style;
+    };
+
+    std::vector<Slot> Slots;
+    std::size_t       Used = 0;
+    std::size_t       HitCount = 0;
+    std::size_t       MissCount = 0;
+  };
+
+}
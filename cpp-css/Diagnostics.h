@@ -0,0 +1,142 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////
+//  Diagnostics
+//   - Parsers never print.  When something is wrong with
+//     the input they report a compact Diagnostic (what
+//     went wrong and the byte offset it went wrong at) to
+//     the DiagnosticSink attached to their cursor
+//   - With no sink attached (the default) a report costs
+//     one pointer test.  Cursors built on
+//     NullDiagnosticSink (QuietBufferCursor) drop
+//     reporting at compile time, and defining
+//     CSS_NO_DIAGNOSTICS removes it from every parser
+//   - BufferDiagnosticSink records into an array the
+//     caller owns and never allocates; anything that
+//     doesn't fit is only counted
+//
+//     css::Diagnostic Issues[64];
+//     css::BufferDiagnosticSink Sink(Issues);
+//     sheet.Parse(Source, &Sink);
+//     for (const auto &Issue : Sink) ...
+//
+//     css::SetStreamDiagnostics(Stream, &Sink);   // Cursor.h
+//     Stream >> Block;                            // reports to Sink
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  enum class DiagnosticCode : std::uint16_t
+  {
+    InvalidSource,        // the stream or buffer was unusable
+    InvalidSelector,      // a rule's selector list was ill-formed, so the rule was skipped
+    InvalidDeclaration,   // a declaration was ill-formed, so the rest of its block was skipped
+    UnterminatedBlock,    // a declaration block ran to the end of the input without a '}'
+    UnterminatedComment   // a comment ran to the end of the input without a '*/'
+  };
+
+  struct Diagnostic
+  {
+    DiagnosticCode Code = DiagnosticCode::InvalidSource;
+    std::uint32_t  Offset = 0;
+  };
+
+  class DiagnosticSink
+  {
+  public:
+
+    virtual ~DiagnosticSink() = default;
+
+    virtual void Report(const Diagnostic &Issue) = 0;
+  };
+
+  /* Not a DiagnosticSink: a cursor built on it (QuietBufferCursor, Cursor.h) never calls it, so
+     reporting compiles away */
+  class NullDiagnosticSink final
+  {
+  public:
+
+    void Report(const Diagnostic &) { }
+  };
+
+  class BufferDiagnosticSink final : public DiagnosticSink
+  {
+  public:
+
+    BufferDiagnosticSink(Diagnostic *Storage, std::size_t Capacity) : Issues(Storage), Capacity(Capacity) { }
+
+    template <std::size_t N>
+    explicit BufferDiagnosticSink(Diagnostic (&Storage)[N]) : BufferDiagnosticSink(Storage, N) { }
+
+    void Report(const Diagnostic &Issue) override
+    {
+      if (Recorded < Capacity)
+        Issues[Recorded++] = Issue;
+      else
+        ++Overflow;
+    }
+
+    std::size_t Count() const { return Recorded; }
+    std::size_t Dropped() const { return Overflow; }
+    void Clear() { Recorded = Overflow = 0; }
+
+    const Diagnostic &operator[](std::size_t Index) const { return Issues[Index]; }
+    const Diagnostic *begin() const { return Issues; }
+    const Diagnostic *end() const { return Issues + Recorded; }
+
+  private:
+
+    Diagnostic *Issues;
+    std::size_t Capacity;
+    std::size_t Recorded = 0;
+    std::size_t Overflow = 0;
+  };
+
+}
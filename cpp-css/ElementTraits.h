@@ -0,0 +1,156 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////
+//  Element
+//   - What the matcher needs to know about a node in your
+//     tree, as virtual functions.  Derive from it (or wrap
+//     your own node type) and hand it to a SelectorMatcher
+//   - Returned views only have to stay valid until the
+//     matcher returns
+//
+//  ElementTraits
+//   - The same questions, answered at compile time.
+//     Specialize ElementTraits for your own node type and
+//     use BasicSelectorMatcher<YourNode>; every accessor is
+//     then a direct (usually inlined) call and nothing is
+//     allocated or copied
+//
+//     template <> struct css::ElementTraits<Widget>  // at namespace scope
+//     {
+//       static std::string_view Tag(const Widget &W) { return W.Kind; }
+//       static std::string_view Id(const Widget &W) { return W.Name; }
+//       static const std::vector<std::string> &Classes(const Widget &W) { return W.Classes; }
+//       static bool Attribute(const Widget &W, std::string_view Name, std::string_view &Value);
+//       static const Widget* Parent(const Widget &W) { return W.Owner; }
+//       static const Widget* PreviousSibling(const Widget &W) { return W.Previous; }
+//     };
+//
+//   - Classes() may return anything you can range-for over
+//     whose items convert to std::string_view
+//   - Optionally, if your nodes intern their names against
+//     the sheet themselves (AtomTable::Find, once), add
+//
+//       static ElementKeys Keys(const Widget &W, const Stylesheet &Sheet);
+//
+//     giving the tag, id and class atoms (NullAtom for a
+//     name the sheet doesn't have).  The matcher then uses
+//     those instead of looking Tag / Id / Classes up
+//   - ElementTraits<Element> is provided, and is what
+//     SelectorMatcher uses
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  class Element
+  {
+  public:
+    virtual ~Element() = default;
+
+    virtual std::string_view Tag() const = 0;
+    virtual std::string_view Id() const = 0;
+    virtual std::size_t ClassCount() const = 0;
+    virtual std::string_view ClassAt(std::size_t Index) const = 0;
+
+    /* False if the element doesn't have the attribute at all */
+    virtual bool Attribute(std::string_view Name, std::string_view &Value) const = 0;
+
+    /* nullptr at the root / for the first child */
+    virtual const Element* Parent() const = 0;
+    virtual const Element* PreviousSibling() const = 0;
+  };
+
+  template <class T>
+  struct ElementTraits;
+
+  /* Element::ClassAt as something to range-for over */
+  class ElementClasses
+  {
+  public:
+
+    class iterator
+    {
+    public:
+      iterator(const Element &Owner, std::size_t Index) : Owner(&Owner), Index(Index) { }
+
+      std::string_view operator*() const { return Owner->ClassAt(Index); }
+      iterator& operator++() { ++Index; return *this; }
+      bool operator!=(const iterator &Other) const { return Index != Other.Index; }
+
+    private:
+      const Element *Owner;
+      std::size_t    Index;
+    };
+
+    explicit ElementClasses(const Element &Owner) : Owner(Owner) { }
+
+    iterator begin() const { return iterator(Owner, 0); }
+    iterator end() const { return iterator(Owner, Owner.ClassCount()); }
+
+  private:
+    const Element &Owner;
+  };
+
+  template <>
+  struct ElementTraits<Element>
+  {
+    static std::string_view Tag(const Element &E) { return E.Tag(); }
+    static std::string_view Id(const Element &E) { return E.Id(); }
+    static ElementClasses Classes(const Element &E) { return ElementClasses(E); }
+    static bool Attribute(const Element &E, std::string_view Name, std::string_view &Value) { return E.Attribute(Name, Value); }
+    static const Element* Parent(const Element &E) { return E.Parent(); }
+    static const Element* PreviousSibling(const Element &E) { return E.PreviousSibling(); }
+  };
+
+  /* Anything derived from Element is read through the Element interface */
+  template <class T>
+  using TraitsNodeType = std::conditional_t<std::is_base_of<Element, T>::value, Element, T>;
+
+}
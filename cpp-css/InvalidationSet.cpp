@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <InvalidationSet.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+
+namespace css
+{
+
+  namespace
+  {
+
+    void SortUnique(std::vector<FeatureKey> &Keys)
+    {
+      std::sort(Keys.begin(), Keys.end());
+      Keys.erase(std::unique(Keys.begin(), Keys.end()), Keys.end());
+    }
+
+  }
+
+  /************************************************************************/
+  /* InvalidationSet                                                      */
+  /************************************************************************/
+
+  void InvalidationSet::Merge(const InvalidationSet &Other)
+  {
+    Self = Self || Other.Self;
+    AllDescendants = AllDescendants || Other.AllDescendants;
+    AllSiblings = AllSiblings || Other.AllSiblings;
+    SiblingDescendants = SiblingDescendants || Other.SiblingDescendants;
+
+    DescendantKeys.insert(DescendantKeys.end(), Other.DescendantKeys.begin(), Other.DescendantKeys.end());
+    SiblingKeys.insert(SiblingKeys.end(), Other.SiblingKeys.begin(), Other.SiblingKeys.end());
+    SortUnique(DescendantKeys);
+    SortUnique(SiblingKeys);
+  }
+
+  void InvalidationSet::Clear()
+  {
+    Entries.clear();
+    Self = AllDescendants = AllSiblings = SiblingDescendants = false;
+    DescendantKeys.clear();
+    SiblingKeys.clear();
+  }
+
+  /************************************************************************/
+  /* InvalidationSets                                                     */
+  /************************************************************************/
+
+  InvalidationSets::InvalidationSets(const Stylesheet &Sheet)
+    : ClassSets(Sheet.Atoms.Size(), 0), IDSets(Sheet.Atoms.Size(), 0), AttributeSets(Sheet.Atoms.Size(), 0)
+  {
+    for (std::uint32_t s = 0; s < ( std::uint32_t )Sheet.Selectors.size(); ++s) {
+      const SelectorRecord &Selector = Sheet.Selectors[s];
+      const std::uint32_t Last = Selector.CompoundCount - 1;
+
+      Atom SubjectName = NullAtom;
+      const BucketKind SubjectKind = RuleIndex::KeyOf(Sheet, s, SubjectName);
+      const bool Narrowed = SubjectKind != BucketKind::Universal;
+      const FeatureKey SubjectKey = MakeFeatureKey(SubjectKind, SubjectName);
+
+      /* Walking right to left, whether some combinator to the right is a descendant / child one */
+      bool AncestorToRight = false;
+
+      for (std::uint32_t c = Last + 1; c-- > 0; ) {
+        InvalidationPosition Position = InvalidationPosition::Subject;
+        if (c != Last) {
+          const Combinator Right = Sheet.Compounds[Selector.FirstCompound + c + 1].LeftCombinator;
+          const bool IsAncestor = Right == Combinator::Descendant || Right == Combinator::Child;
+          Position = IsAncestor ? InvalidationPosition::Ancestor : InvalidationPosition::Sibling;
+          AncestorToRight = AncestorToRight || IsAncestor;
+        }
+
+        const CompoundRecord &Compound = Sheet.Compounds[Selector.FirstCompound + c];
+        for (std::uint32_t i = Compound.FirstSimple; i < Compound.FirstSimple + Compound.SimpleCount; ++i) {
+          const SimpleSelectorRecord &Simple = Sheet.SimpleSelectors[i];
+          if (Simple.Kind != SimpleSelectorKind::Class && Simple.Kind != SimpleSelectorKind::ID && Simple.Kind != SimpleSelectorKind::Attribute)
+            continue;
+
+          InvalidationSet &Set = SetFor(Simple.Kind, Simple.Name);
+          Set.Entries.push_back({ s, c, Position });
+
+          switch (Position)
+          {
+            case InvalidationPosition::Subject:
+              Set.Self = true;
+              break;
+            case InvalidationPosition::Ancestor:
+              if (Narrowed)
+                Set.DescendantKeys.push_back(SubjectKey);
+              else
+                Set.AllDescendants = true;
+              break;
+            case InvalidationPosition::Sibling:
+              if (Narrowed)
+                Set.SiblingKeys.push_back(SubjectKey);
+              else
+                Set.AllSiblings = true;
+              Set.SiblingDescendants = Set.SiblingDescendants || AncestorToRight;
+              break;
+          }
+        }
+      }
+    }
+
+    for (InvalidationSet &Set : Sets) {
+      SortUnique(Set.DescendantKeys);
+      SortUnique(Set.SiblingKeys);
+    }
+  }
+
+  InvalidationSet& InvalidationSets::SetFor(SimpleSelectorKind Kind, Atom Name)
+  {
+    std::vector<std::uint32_t> &Index = Kind == SimpleSelectorKind::Class ? ClassSets : Kind == SimpleSelectorKind::ID ? IDSets : AttributeSets;
+    if (Index[Name] == 0) {
+      Sets.emplace_back();
+      Index[Name] = ( std::uint32_t )Sets.size();
+    }
+    return Sets[Index[Name] - 1];
+  }
+
+  const InvalidationSet* InvalidationSets::Find(SimpleSelectorKind Kind, Atom Name) const
+  {
+    const std::vector<std::uint32_t> *Index = nullptr;
+    switch (Kind)
+    {
+      case SimpleSelectorKind::Class:     Index = &ClassSets; break;
+      case SimpleSelectorKind::ID:        Index = &IDSets; break;
+      case SimpleSelectorKind::Attribute: Index = &AttributeSets; break;
+      default:                            return nullptr;
+    }
+
+    if (Name == NullAtom || Name >= Index->size() || ( *Index )[Name] == 0)
+      return nullptr;
+    return &Sets[( *Index )[Name] - 1];
+  }
+
+}
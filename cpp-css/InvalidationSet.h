@@ -0,0 +1,138 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Stylesheet.h>
+#include <RuleIndex.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  InvalidationSets
+//   - For every class, id and attribute name in a sheet,
+//     which selectors mention it and in what position:
+//     in the subject (rightmost) compound, in an ancestor
+//     compound, or in a sibling compound
+//   - Each name's InvalidationSet sums that up as what a
+//     change to the name on one element can restyle:
+//     the element itself, its descendants, its later
+//     siblings (and maybe their descendants).  Descendants
+//     and siblings are further narrowed to the ones
+//     carrying the subject key (see RuleIndex::KeyOf) of
+//     one of those selectors; only a selector whose
+//     subject has no id, class or type opens up all of
+//     them
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  enum class InvalidationPosition : std::uint8_t
+  {
+    Subject,
+    Ancestor,
+    Sibling
+  };
+
+  struct InvalidationEntry
+  {
+    std::uint32_t        Selector = 0;
+    std::uint32_t        Compound = 0;
+    InvalidationPosition Position = InvalidationPosition::Subject;
+  };
+
+  /* A RuleIndex key packed as (kind << 32) | atom */
+  using FeatureKey = std::uint64_t;
+
+  __forceinline FeatureKey MakeFeatureKey(BucketKind Kind, Atom Name)
+  {
+    return ( ( FeatureKey )Kind << 32 ) | Name;
+  }
+
+  struct InvalidationSet
+  {
+    std::vector<InvalidationEntry> Entries;
+
+    bool Self = false;
+
+    /* Descendants carrying one of DescendantKeys (sorted), or all of them */
+    bool                    AllDescendants = false;
+    std::vector<FeatureKey> DescendantKeys;
+
+    /* Later siblings carrying one of SiblingKeys (sorted), or all of them;
+       with SiblingDescendants, the same goes for their descendants */
+    bool                    AllSiblings = false;
+    bool                    SiblingDescendants = false;
+    std::vector<FeatureKey> SiblingKeys;
+
+    bool Empty() const { return !Self && !AllDescendants && DescendantKeys.empty() && !AllSiblings && SiblingKeys.empty(); }
+    bool AffectsDescendants() const { return AllDescendants || !DescendantKeys.empty(); }
+    bool AffectsSiblings() const { return AllSiblings || !SiblingKeys.empty(); }
+
+    /* Everything Other restyles, this now restyles too */
+    void Merge(const InvalidationSet &Other);
+    void Clear();
+  };
+
+  class InvalidationSets
+  {
+  public:
+
+    explicit InvalidationSets(const Stylesheet &Sheet);
+
+    /* nullptr if no selector mentions Name as a Kind (Class, ID or Attribute) */
+    const InvalidationSet* Find(SimpleSelectorKind Kind, Atom Name) const;
+
+  private:
+
+    InvalidationSet& SetFor(SimpleSelectorKind Kind, Atom Name);
+
+    /* Per atom, index + 1 into Sets; 0 for none */
+    std::vector<std::uint32_t>   ClassSets;
+    std::vector<std::uint32_t>   IDSets;
+    std::vector<std::uint32_t>   AttributeSets;
+    std::vector<InvalidationSet> Sets;
+  };
+
+}
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <MappedFile.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <utility>
+
+namespace css
+{
+
+  /* Zero-length files can't be mapped, but they still parse (to nothing) */
+  static const char EmptyFile[] = "";
+
+  MappedFile::MappedFile(MappedFile &&Other) noexcept
+  {
+    Swap(Other);
+  }
+
+  MappedFile &MappedFile::operator=(MappedFile &&Other) noexcept
+  {
+    if (this != &Other) {
+      Close();
+      Swap(Other);
+    }
+    return *this;
+  }
+
+  void MappedFile::Swap(MappedFile &Other) noexcept
+  {
+    std::swap(Data, Other.Data);
+    std::swap(Length, Other.Length);
+#ifdef _WIN32
+    std::swap(FileHandle, Other.FileHandle);
+    std::swap(MappingHandle, Other.MappingHandle);
+#else
+    std::swap(Descriptor, Other.Descriptor);
+#endif
+  }
+
+#ifdef _WIN32
+
+  bool MappedFile::Open(const std::string &Path)
+  {
+    Close();
+
+    HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (File == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize)) {
+      CloseHandle(File);
+      return false;
+    }
+
+    FileHandle = File;
+
+    if (FileSize.QuadPart == 0) {
+      Data = EmptyFile;
+      Length = 0;
+      return true;
+    }
+
+    HANDLE Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!Mapping) {
+      Close();
+      return false;
+    }
+
+    MappingHandle = Mapping;
+
+    const void *View = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!View) {
+      Close();
+      return false;
+    }
+
+    Data = static_cast<const char *>(View);
+    Length = static_cast<std::size_t>(FileSize.QuadPart);
+    return true;
+  }
+
+  void MappedFile::Close()
+  {
+    if (Data && Data != EmptyFile)
+      UnmapViewOfFile(Data);
+    if (MappingHandle)
+      CloseHandle(MappingHandle);
+    if (FileHandle)
+      CloseHandle(FileHandle);
+
+    Data = nullptr;
+    Length = 0;
+    MappingHandle = nullptr;
+    FileHandle = nullptr;
+  }
+
+#else
+
+  bool MappedFile::Open(const std::string &Path)
+  {
+    Close();
+
+    int File = ::open(Path.c_str(), O_RDONLY);
+    if (File < 0)
+      return false;
+
+    struct stat Info;
+    if (::fstat(File, &Info) != 0) {
+      ::close(File);
+      return false;
+    }
+
+    Descriptor = File;
+
+    if (Info.st_size == 0) {
+      Data = EmptyFile;
+      Length = 0;
+      return true;
+    }
+
+    void *View = ::mmap(nullptr, static_cast<std::size_t>(Info.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+    if (View == MAP_FAILED) {
+      Close();
+      return false;
+    }
+
+    /* The parsers walk the file front to back exactly once */
+    ::madvise(View, static_cast<std::size_t>(Info.st_size), MADV_SEQUENTIAL);
+
+    Data = static_cast<const char *>(View);
+    Length = static_cast<std::size_t>(Info.st_size);
+    return true;
+  }
+
+  void MappedFile::Close()
+  {
+    if (Data && Data != EmptyFile)
+      ::munmap(const_cast<char *>(Data), Length);
+    if (Descriptor >= 0)
+      ::close(Descriptor);
+
+    Data = nullptr;
+    Length = 0;
+    Descriptor = -1;
+  }
+
+#endif
+
+}
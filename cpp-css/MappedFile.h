@@ -0,0 +1,107 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Cursor.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+////////////////////////////////////////////////////////////
+//  MappedFile
+//   - Maps a stylesheet read-only into memory so the
+//     buffer parsers can run over it directly.  No copy
+//     of the file is ever made
+//   - Views parsed from Cursor() borrow from the mapping
+//     and are only valid while the MappedFile is open.
+//     Call Materialize() on anything that has to outlive it
+//
+//     css::MappedFile Sheet("theme.css");
+//     css::BufferCursor Input = Sheet.Cursor();
+//     css::TypeSelectorView Type;
+//     Input >> Type;
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  class MappedFile
+  {
+  public:
+
+    MappedFile() = default;
+    explicit MappedFile(const std::string &Path) { Open(Path); }
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&Other) noexcept;
+    MappedFile &operator=(MappedFile &&Other) noexcept;
+
+    bool Open(const std::string &Path);
+    void Close();
+
+    bool IsOpen() const { return Data != nullptr; }
+    operator bool() const { return IsOpen(); }
+
+    std::size_t Size() const { return Length; }
+    std::string_view View() const { return std::string_view(Data, Length); }
+    BufferCursor Cursor() const { return BufferCursor(Data, Data + Length); }
+
+  private:
+
+    void Swap(MappedFile &Other) noexcept;
+
+    const char *Data = nullptr;
+    std::size_t Length = 0;
+
+#ifdef _WIN32
+    void *FileHandle = nullptr;
+    void *MappingHandle = nullptr;
+#else
+    int Descriptor = -1;
+#endif
+  };
+
+}
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Matcher.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  namespace
+  {
+
+    /* Whether Value has Word as one of its whitespace-separated words */
+    bool ContainsWord(std::string_view Value, std::string_view Word)
+    {
+      if (Word.empty())
+        return false;
+
+      std::size_t Pos = 0;
+      while (Pos < Value.size()) {
+        while (Pos < Value.size() && IsWhitespaceByte(( unsigned char )Value[Pos]))
+          ++Pos;
+        std::size_t End = Pos;
+        while (End < Value.size() && !IsWhitespaceByte(( unsigned char )Value[End]))
+          ++End;
+        if (Value.substr(Pos, End - Pos) == Word)
+          return true;
+        Pos = End;
+      }
+      return false;
+    }
+
+  }
+
+  bool MatchesAttributeValue(std::string_view Comparison, std::string_view Actual, std::string_view Expected)
+  {
+    if (Comparison == "=")
+      return Actual == Expected;
+    if (Comparison == "~=")
+      return ContainsWord(Actual, Expected);
+    if (Comparison == "|=")
+      return Actual == Expected || ( Actual.size() > Expected.size() && Actual.substr(0, Expected.size()) == Expected && Actual[Expected.size()] == '-' );
+    if (Expected.empty())
+      return false;
+    if (Comparison == "^=")
+      return Actual.substr(0, Expected.size()) == Expected;
+    if (Comparison == "$=")
+      return Actual.size() >= Expected.size() && Actual.substr(Actual.size() - Expected.size()) == Expected;
+    if (Comparison == "*=")
+      return Actual.find(Expected) != std::string_view::npos;
+    return false;
+  }
+
+  template class BasicSelectorMatcher<Element>;
+
+}
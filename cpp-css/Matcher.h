@@ -0,0 +1,395 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Stylesheet.h>
+#include <RuleIndex.h>
+#include <ElementTraits.h>
+#include <AncestorFilter.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  BasicSelectorMatcher
+//   - Matches the selectors of a Stylesheet against nodes
+//     of any type with an ElementTraits specialization
+//     (ElementTraits.h), right to left: the rightmost
+//     compound is checked against the node first, and
+//     only if it matches does the matcher walk to parents
+//     / previous siblings for the compounds to its left.
+//     Most selectors are rejected by their rightmost
+//     compound without touching the rest of the tree
+//   - With a RuleIndex, only the selectors that share a
+//     key with the node are tried at all.  Each bucket's
+//     matches come out in cascade order already, so they
+//     are merged rather than sorted
+//   - With an AncestorFilter holding the node's ancestors,
+//     selectors whose ancestor requirements can't be met
+//     are rejected with a few bit tests
+//   - A node's tag, id and classes are looked up in the
+//     sheet's AtomTable once per match call (and once for
+//     each parent or sibling walked to), so type, id and
+//     class selectors are integer compares.  The cache
+//     behind this makes a matcher single threaded.  Traits
+//     with a Keys() function (see ElementTraits) hand over
+//     atoms they interned themselves and skip the lookup
+//
+//  SelectorMatcher
+//   - BasicSelectorMatcher<Element>, for trees exposed
+//     through the virtual Element interface
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  /* True if Traits has the optional Keys(const T&, const Stylesheet&) */
+  template <class Traits, class T, class = void>
+  struct HasAtomKeys : std::false_type { };
+
+  template <class Traits, class T>
+  struct HasAtomKeys<Traits, T, std::void_t<decltype(Traits::Keys(std::declval<const T&>(), std::declval<const Stylesheet&>()))>>
+    : std::true_type { };
+
+  /* Attribute comparisons: "=", "~=", "|=", "^=", "$=" and "*=" */
+  bool MatchesAttributeValue(std::string_view Comparison, std::string_view Actual, std::string_view Expected);
+
+  template <class T>
+  class BasicSelectorMatcher
+  {
+  public:
+
+    using Traits = ElementTraits<T>;
+
+    explicit BasicSelectorMatcher(const Stylesheet &Sheet)
+      : Sheet(Sheet)
+    {
+      Hashes.reserve(Sheet.Selectors.size());
+      for (std::uint32_t s = 0; s < ( std::uint32_t )Sheet.Selectors.size(); ++s)
+        Hashes.push_back(AncestorFilter::HashesOf(Sheet, s));
+
+      Sheet.CascadeOrder(Cascade);
+    }
+
+    /* Filter, if given, must hold exactly Subject's ancestors */
+    bool Matches(std::uint32_t Selector, const T &Subject, const AncestorFilter *Filter = nullptr) const
+    {
+      return Matches(Selector, Subject, BeginMatch(Subject), Filter);
+    }
+
+    /* How many selectors an AncestorFilter has ruled out without walking the tree */
+    std::size_t FilterRejections() const { return Rejected; }
+
+    bool MatchesCompound(const CompoundRecord &Compound, const T &Subject) const
+    {
+      return MatchesCompound(Compound, Subject, BeginMatch(Subject));
+    }
+
+    /* Appends every selector matching Subject to Out, lowest cascade rank first
+       (see Stylesheet::CascadeOrder) */
+    void CollectMatches(const T &Subject, std::vector<std::uint32_t> &Out, const AncestorFilter *Filter = nullptr) const
+    {
+      const ElementKeys Keys = BeginMatch(Subject);
+      for (std::uint32_t s : Cascade)
+        if (Matches(s, Subject, Keys, Filter))
+          Out.push_back(s);
+    }
+
+    void CollectMatches(const RuleIndex &Index, const T &Subject, std::vector<std::uint32_t> &Out,
+                        const AncestorFilter *Filter = nullptr)
+    {
+      const std::size_t First = Out.size();
+      const ElementKeys Keys = BeginMatch(Subject);
+
+      auto CascadeLess = [this](std::uint32_t Left, std::uint32_t Right) { return Sheet.CascadeKey(Left) < Sheet.CascadeKey(Right); };
+
+      /* Each bucket is already in cascade order; merge its matches into what came before */
+      auto MatchBucket = [&](RuleBucket Bucket)
+      {
+        const std::size_t RunStart = Out.size();
+        for (std::uint32_t Selector : Bucket)
+          if (Matches(Selector, Subject, Keys, Filter))
+            Out.push_back(Selector);
+
+        if (RunStart == First || RunStart == Out.size())
+          return;
+
+        MergeScratch.clear();
+        std::merge(Out.begin() + First, Out.begin() + RunStart, Out.begin() + RunStart, Out.end(),
+                   std::back_inserter(MergeScratch), CascadeLess);
+        std::copy(MergeScratch.begin(), MergeScratch.end(), Out.begin() + First);
+      };
+
+      MatchBucket(Index.IDBucket(Keys.Id));
+      for (std::size_t c = 0; c < Keys.ClassCount; ++c)
+        MatchBucket(Index.ClassBucket(Keys.Classes[c]));
+      MatchBucket(Index.TypeBucket(Keys.Tag));
+      MatchBucket(Index.UniversalBucket());
+
+      /* A node listing the same class twice visits its bucket twice */
+      Out.erase(std::unique(Out.begin() + First, Out.end()), Out.end());
+    }
+
+    const AncestorHashes& HashesOf(std::uint32_t Selector) const { return Hashes[Selector]; }
+
+    /* Subject's tag, id and class atoms: from Traits::Keys if the traits have it, otherwise
+       looked up in the sheet's AtomTable, with Classes as storage for the class atoms */
+    ElementKeys KeysOf(const T &Subject, std::vector<Atom> &Classes) const
+    {
+      if constexpr (HasAtomKeys<Traits, T>::value) {
+        return Traits::Keys(Subject, Sheet);
+      }
+      else {
+        ElementKeys Keys;
+        Keys.Tag = Sheet.Atoms.Find(Traits::Tag(Subject));
+
+        const std::string_view Id = Traits::Id(Subject);
+        Keys.Id = Id.empty() ? NullAtom : Sheet.Atoms.Find(Id);
+
+        Classes.clear();
+        for (const auto &Class : Traits::Classes(Subject)) {
+          const Atom Found = Sheet.Atoms.Find(std::string_view(Class));
+          if (Found != NullAtom)
+            Classes.push_back(Found);
+        }
+
+        Keys.Classes = Classes.data();
+        Keys.ClassCount = Classes.size();
+        return Keys;
+      }
+    }
+
+  private:
+
+    /* A parent or sibling walked to while matching, with its keys as KeysOf would give them */
+    struct WalkedElement
+    {
+      const T      *Of;
+      Atom          Tag;
+      Atom          Id;
+      std::uint32_t FirstClass;
+      std::uint32_t ClassCount;
+    };
+
+    struct WalkedSlot
+    {
+      std::uint32_t Generation = 0;
+      std::uint32_t Index = 0;
+    };
+
+    /* Starts a match call: forgets the elements walked to by the last one and looks up the subject */
+    ElementKeys BeginMatch(const T &Subject) const
+    {
+      Walked.clear();
+      WalkedClasses.clear();
+      if (++WalkedGeneration == 0) {
+        WalkedSlots.assign(WalkedSlots.size(), WalkedSlot());
+        WalkedGeneration = 1;
+      }
+      return KeysOf(Subject, ClassScratch);
+    }
+
+    /* The keys of an element walked to.  Looked up the first time it is reached, and found again
+       through a small open-addressed table keyed by its address, so walking up a deep tree from
+       many compounds stays linear.  The returned keys point into WalkedClasses, so they are only
+       good until the next call */
+    ElementKeys WalkedKeys(const T &Of) const
+    {
+      if constexpr (HasAtomKeys<Traits, T>::value) {
+        return Traits::Keys(Of, Sheet);
+      }
+      else {
+        std::size_t Slot = FindWalked(&Of);
+
+        if (WalkedSlots[Slot].Generation != WalkedGeneration) {
+          const ElementKeys Keys = KeysOf(Of, LookupScratch);
+          const auto FirstClass = ( std::uint32_t )WalkedClasses.size();
+          WalkedClasses.insert(WalkedClasses.end(), LookupScratch.begin(), LookupScratch.end());
+          Walked.push_back({ &Of, Keys.Tag, Keys.Id, FirstClass, ( std::uint32_t )LookupScratch.size() });
+
+          if (Walked.size() * 2 > WalkedSlots.size()) {
+            GrowWalked();
+            Slot = FindWalked(&Of);
+          }
+          WalkedSlots[Slot] = { WalkedGeneration, ( std::uint32_t )Walked.size() - 1 };
+        }
+
+        const WalkedElement &Found = Walked[WalkedSlots[Slot].Index];
+        ElementKeys Keys;
+        Keys.Tag = Found.Tag;
+        Keys.Id = Found.Id;
+        Keys.Classes = WalkedClasses.data() + Found.FirstClass;
+        Keys.ClassCount = Found.ClassCount;
+        return Keys;
+      }
+    }
+
+    /* Of's slot in WalkedSlots, or the empty slot it would go in.  A slot is empty when its
+       generation isn't this match call's, so starting a call doesn't clear the table */
+    std::size_t FindWalked(const T *Of) const
+    {
+      const std::size_t Mask = WalkedSlots.size() - 1;
+      std::size_t Slot = ( std::size_t )( ( reinterpret_cast<std::uintptr_t>(Of) * 0x9E3779B97F4A7C15ull ) >> 32 ) & Mask;
+
+      while (WalkedSlots[Slot].Generation == WalkedGeneration && Walked[WalkedSlots[Slot].Index].Of != Of)
+        Slot = ( Slot + 1 ) & Mask;
+      return Slot;
+    }
+
+    void GrowWalked() const
+    {
+      WalkedSlots.assign(WalkedSlots.size() * 2, WalkedSlot());
+      for (std::uint32_t i = 0; i < ( std::uint32_t )Walked.size(); ++i)
+        WalkedSlots[FindWalked(Walked[i].Of)] = { WalkedGeneration, i };
+    }
+
+    /* Keys must be Subject's, from BeginMatch */
+    bool Matches(std::uint32_t Selector, const T &Subject, const ElementKeys &Keys, const AncestorFilter *Filter = nullptr) const
+    {
+      if (Filter && !Filter->MightMatch(Hashes[Selector])) {
+        ++Rejected;
+        return false;
+      }
+
+      const SelectorRecord &Record = Sheet.Selectors[Selector];
+      return MatchFrom(Record, Record.CompoundCount - 1, Subject, Keys);
+    }
+
+    bool MatchesCompound(const CompoundRecord &Compound, const T &Subject, const ElementKeys &Keys) const
+    {
+      for (std::uint32_t s = Compound.FirstSimple; s < Compound.FirstSimple + Compound.SimpleCount; ++s)
+        if (!MatchesSimple(Sheet.SimpleSelectors[s], Subject, Keys))
+          return false;
+      return true;
+    }
+
+    bool MatchFrom(const SelectorRecord &Selector, std::uint32_t Compound, const T &Subject, const ElementKeys &Keys) const
+    {
+      const CompoundRecord &Record = Sheet.Compounds[Selector.FirstCompound + Compound];
+
+      if (!MatchesCompound(Record, Subject, Keys))
+        return false;
+      if (Compound == 0)
+        return true;
+
+      const T *Next = nullptr;
+
+      switch (Record.LeftCombinator)
+      {
+        case Combinator::Child:
+          Next = Traits::Parent(Subject);
+          return Next && MatchFrom(Selector, Compound - 1, *Next, WalkedKeys(*Next));
+
+        case Combinator::NextSibling:
+          Next = Traits::PreviousSibling(Subject);
+          return Next && MatchFrom(Selector, Compound - 1, *Next, WalkedKeys(*Next));
+
+        case Combinator::Descendant:
+          for (Next = Traits::Parent(Subject); Next; Next = Traits::Parent(*Next))
+            if (MatchFrom(Selector, Compound - 1, *Next, WalkedKeys(*Next)))
+              return true;
+          return false;
+
+        case Combinator::SubsequentSibling:
+          for (Next = Traits::PreviousSibling(Subject); Next; Next = Traits::PreviousSibling(*Next))
+            if (MatchFrom(Selector, Compound - 1, *Next, WalkedKeys(*Next)))
+              return true;
+          return false;
+
+        case Combinator::None:
+          break;
+      }
+      return false;
+    }
+
+    /* A name the sheet never interned is NullAtom in Keys, which no selector's name is */
+    bool MatchesSimple(const SimpleSelectorRecord &Simple, const T &Subject, const ElementKeys &Keys) const
+    {
+      switch (Simple.Kind)
+      {
+        case SimpleSelectorKind::Universal:
+          return true;
+        case SimpleSelectorKind::Type:
+          return Simple.Name == Keys.Tag;
+        case SimpleSelectorKind::ID:
+          return Simple.Name == Keys.Id;
+        case SimpleSelectorKind::Class:
+          return std::find(Keys.Classes, Keys.Classes + Keys.ClassCount, Simple.Name) != Keys.Classes + Keys.ClassCount;
+        case SimpleSelectorKind::Attribute:
+        {
+          std::string_view Value;
+          if (!Traits::Attribute(Subject, Sheet.TextOf(Simple.Name), Value))
+            return false;
+          return Simple.Comparison.Length == 0 || MatchesAttributeValue(Sheet.TextOf(Simple.Comparison), Value, Sheet.TextOf(Simple.Value));
+        }
+      }
+      return false;
+    }
+
+    const Stylesheet           &Sheet;
+    std::vector<AncestorHashes> Hashes;
+    std::vector<std::uint32_t>  Cascade;
+    std::vector<std::uint32_t>  MergeScratch;
+    mutable std::size_t         Rejected = 0;
+
+    /* Per match call; the subject's class atoms are kept apart from the walked elements' so
+       its keys stay valid while those grow */
+    mutable std::vector<Atom>          ClassScratch;
+    mutable std::vector<Atom>          LookupScratch;
+    mutable std::vector<WalkedElement> Walked;
+    mutable std::vector<Atom>          WalkedClasses;
+    mutable std::vector<WalkedSlot>    WalkedSlots = std::vector<WalkedSlot>(16);
+    mutable std::uint32_t              WalkedGeneration = 0;
+  };
+
+  /* Instantiated once, in Matcher.cpp */
+  extern template class BasicSelectorMatcher<Element>;
+
+  using SelectorMatcher = BasicSelectorMatcher<Element>;
+
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+////////////////////////////////////////////////////////////
+//  PropertyId
+//   - A dense id for every CSS property this library
+//     knows by name, so code can switch on a property (or
+//     index an array by it) instead of comparing strings
+//   - Names are looked up with a perfect hash built at
+//     compile time: one hash, one table load and one
+//     compare.  Case is ignored, as in CSS
+//   - Custom properties ("--anything") are Custom, and
+//     everything else is Unknown.  Either way the text is
+//     kept wherever the id is, so nothing is lost
+//   - To add a property, add it to CSS_PROPERTIES.  If the
+//     new name collides, the compile-time search moves on
+//     to the next seed by itself
+//
+////////////////////////////////////////////////////////////
+
+#define CSS_PROPERTIES(X) \
+  X(AlignContent,        "align-content") \
+  X(AlignItems,          "align-items") \
+  X(AlignSelf,           "align-self") \
+  X(Animation,           "animation") \
+  X(AnimationDelay,      "animation-delay") \
+  X(AnimationDuration,   "animation-duration") \
+  X(AnimationName,       "animation-name") \
+  X(Background,          "background") \
+  X(BackgroundColor,     "background-color") \
+  X(BackgroundImage,     "background-image") \
+  X(BackgroundPosition,  "background-position") \
+  X(BackgroundRepeat,    "background-repeat") \
+  X(BackgroundSize,      "background-size") \
+  X(Border,              "border") \
+  X(BorderBottom,        "border-bottom") \
+  X(BorderBottomColor,   "border-bottom-color") \
+  X(BorderBottomWidth,   "border-bottom-width") \
+  X(BorderCollapse,      "border-collapse") \
+  X(BorderColor,         "border-color") \
+  X(BorderLeft,          "border-left") \
+  X(BorderRadius,        "border-radius") \
+  X(BorderRight,         "border-right") \
+  X(BorderSpacing,       "border-spacing") \
+  X(BorderStyle,         "border-style") \
+  X(BorderTop,           "border-top") \
+  X(BorderWidth,         "border-width") \
+  X(Bottom,              "bottom") \
+  X(BoxShadow,           "box-shadow") \
+  X(BoxSizing,           "box-sizing") \
+  X(Clear,               "clear") \
+  X(Color,               "color") \
+  X(ColumnGap,           "column-gap") \
+  X(Columns,             "columns") \
+  X(Content,             "content") \
+  X(Cursor,              "cursor") \
+  X(Direction,           "direction") \
+  X(Display,             "display") \
+  X(Filter,              "filter") \
+  X(Flex,                "flex") \
+  X(FlexBasis,           "flex-basis") \
+  X(FlexDirection,       "flex-direction") \
+  X(FlexFlow,            "flex-flow") \
+  X(FlexGrow,            "flex-grow") \
+  X(FlexShrink,          "flex-shrink") \
+  X(FlexWrap,            "flex-wrap") \
+  X(Float,               "float") \
+  X(Font,                "font") \
+  X(FontFamily,          "font-family") \
+  X(FontSize,            "font-size") \
+  X(FontStyle,           "font-style") \
+  X(FontVariant,         "font-variant") \
+  X(FontWeight,          "font-weight") \
+  X(Gap,                 "gap") \
+  X(Grid,                "grid") \
+  X(GridArea,            "grid-area") \
+  X(GridColumn,          "grid-column") \
+  X(GridRow,             "grid-row") \
+  X(GridTemplate,        "grid-template") \
+  X(GridTemplateAreas,   "grid-template-areas") \
+  X(GridTemplateColumns, "grid-template-columns") \
+  X(GridTemplateRows,    "grid-template-rows") \
+  X(Height,              "height") \
+  X(JustifyContent,      "justify-content") \
+  X(JustifyItems,        "justify-items") \
+  X(JustifySelf,         "justify-self") \
+  X(Left,                "left") \
+  X(LetterSpacing,       "letter-spacing") \
+  X(LineHeight,          "line-height") \
+  X(ListStyle,           "list-style") \
+  X(Margin,              "margin") \
+  X(MarginBottom,        "margin-bottom") \
+  X(MarginLeft,          "margin-left") \
+  X(MarginRight,         "margin-right") \
+  X(MarginTop,           "margin-top") \
+  X(MaxHeight,           "max-height") \
+  X(MaxWidth,            "max-width") \
+  X(MinHeight,           "min-height") \
+  X(MinWidth,            "min-width") \
+  X(Opacity,             "opacity") \
+  X(Order,               "order") \
+  X(Outline,             "outline") \
+  X(OutlineColor,        "outline-color") \
+  X(OutlineOffset,       "outline-offset") \
+  X(OutlineStyle,        "outline-style") \
+  X(OutlineWidth,        "outline-width") \
+  X(Overflow,            "overflow") \
+  X(OverflowX,           "overflow-x") \
+  X(OverflowY,           "overflow-y") \
+  X(Padding,             "padding") \
+  X(PaddingBottom,       "padding-bottom") \
+  X(PaddingLeft,         "padding-left") \
+  X(PaddingRight,        "padding-right") \
+  X(PaddingTop,          "padding-top") \
+  X(PointerEvents,       "pointer-events") \
+  X(Position,            "position") \
+  X(Right,               "right") \
+  X(RowGap,              "row-gap") \
+  X(TextAlign,           "text-align") \
+  X(TextDecoration,      "text-decoration") \
+  X(TextIndent,          "text-indent") \
+  X(TextOverflow,        "text-overflow") \
+  X(TextShadow,          "text-shadow") \
+  X(TextTransform,       "text-transform") \
+  X(Top,                 "top") \
+  X(Transform,           "transform") \
+  X(TransformOrigin,     "transform-origin") \
+  X(Transition,          "transition") \
+  X(TransitionDelay,     "transition-delay") \
+  X(TransitionDuration,  "transition-duration") \
+  X(TransitionProperty,  "transition-property") \
+  X(VerticalAlign,       "vertical-align") \
+  X(Visibility,          "visibility") \
+  X(WhiteSpace,          "white-space") \
+  X(Width,               "width") \
+  X(WordBreak,           "word-break") \
+  X(WordSpacing,         "word-spacing") \
+  X(WordWrap,            "word-wrap") \
+  X(ZIndex,              "z-index")
+
+namespace css
+{
+
+  enum class PropertyId : std::uint16_t
+  {
+    Unknown,
+    Custom,
+#define CSS_PROPERTY_ENUM(ID, NAME) ID,
+    CSS_PROPERTIES(CSS_PROPERTY_ENUM)
+#undef CSS_PROPERTY_ENUM
+    Count
+  };
+
+  namespace Detail
+  {
+
+    /* Indexed by PropertyId */
+    constexpr std::string_view PropertyNames[] = {
+      "",
+      "",
+#define CSS_PROPERTY_NAME(ID, NAME) NAME,
+      CSS_PROPERTIES(CSS_PROPERTY_NAME)
+#undef CSS_PROPERTY_NAME
+    };
+
+    constexpr std::size_t FirstNamedProperty = ( std::size_t )PropertyId::Custom + 1;
+    constexpr std::size_t PropertySlotBits = 10;
+    constexpr std::size_t PropertySlotCount = std::size_t(1) << PropertySlotBits;
+
+    constexpr char FoldCase(char c)
+    {
+      return ( c >= 'A' && c <= 'Z' ) ? ( char )( c | 0x20 ) : c;
+    }
+
+    /* FNV-1a with a seed, then mixed so the low bits depend on every byte */
+    constexpr std::uint32_t HashFoldedName(std::string_view Name, std::uint32_t Seed)
+    {
+      std::uint32_t Hash = Seed ^ 2166136261u;
+      for (char c : Name) {
+        Hash ^= ( unsigned char )FoldCase(c);
+        Hash *= 16777619u;
+      }
+      Hash ^= Hash >> 15;
+      Hash *= 0x2C1B3C6Du;
+      Hash ^= Hash >> 12;
+      return Hash;
+    }
+
+    constexpr bool SeedIsPerfect(std::uint32_t Seed)
+    {
+      std::array<bool, PropertySlotCount> Taken = { };
+      for (std::size_t p = FirstNamedProperty; p < ( std::size_t )PropertyId::Count; ++p) {
+        const std::size_t Slot = HashFoldedName(PropertyNames[p], Seed) & ( PropertySlotCount - 1 );
+        if (Taken[Slot])
+          return false;
+        Taken[Slot] = true;
+      }
+      return true;
+    }
+
+    /* Starts at a seed known to work for the list above */
+    constexpr std::uint32_t FindPropertySeed()
+    {
+      std::uint32_t Seed = 299;
+      while (!SeedIsPerfect(Seed))
+        ++Seed;
+      return Seed;
+    }
+
+    constexpr std::uint32_t PropertySeed = FindPropertySeed();
+
+    /* Slot -> PropertyId, Unknown for empty slots */
+    constexpr std::array<std::uint8_t, PropertySlotCount> BuildPropertySlots()
+    {
+      std::array<std::uint8_t, PropertySlotCount> Slots = { };
+      for (std::size_t p = FirstNamedProperty; p < ( std::size_t )PropertyId::Count; ++p)
+        Slots[HashFoldedName(PropertyNames[p], PropertySeed) & ( PropertySlotCount - 1 )] = ( std::uint8_t )p;
+      return Slots;
+    }
+
+    constexpr std::array<std::uint8_t, PropertySlotCount> PropertySlots = BuildPropertySlots();
+
+    static_assert(( std::size_t )PropertyId::Count <= 256, "PropertySlots stores ids in a byte");
+
+    constexpr bool EqualsFoldingCase(std::string_view Left, std::string_view Right)
+    {
+      if (Left.size() != Right.size())
+        return false;
+      for (std::size_t i = 0; i < Left.size(); ++i)
+        if (FoldCase(Left[i]) != Right[i])
+          return false;
+      return true;
+    }
+
+  }
+
+  constexpr PropertyId LookupProperty(std::string_view Name)
+  {
+    if (Name.size() > 2 && Name[0] == '-' && Name[1] == '-')
+      return PropertyId::Custom;
+
+    const std::uint8_t Candidate = Detail::PropertySlots[Detail::HashFoldedName(Name, Detail::PropertySeed) & ( Detail::PropertySlotCount - 1 )];
+    return ( Candidate != 0 && Detail::EqualsFoldingCase(Name, Detail::PropertyNames[Candidate]) ) ? ( PropertyId )Candidate : PropertyId::Unknown;
+  }
+
+  /* The property's name in lower case; empty for Unknown and Custom */
+  constexpr std::string_view PropertyName(PropertyId Id)
+  {
+    return ( std::size_t )Id < ( std::size_t )PropertyId::Count ? Detail::PropertyNames[( std::size_t )Id] : std::string_view();
+  }
+
+}
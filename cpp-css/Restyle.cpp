@@ -0,0 +1,307 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Restyle.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+
+namespace css
+{
+
+  RestyleEngine::RestyleEngine(const Stylesheet &Sheet)
+    : Sheet(Sheet), Resolver(Sheet), Invalidations(Sheet), Candidates(MaxSharingCandidates)
+  {
+    for (const SimpleSelectorRecord &Simple : Sheet.SimpleSelectors)
+      if (Simple.Kind == SimpleSelectorKind::Attribute)
+        SharingAttributes.push_back(Simple.Name);
+    std::sort(SharingAttributes.begin(), SharingAttributes.end());
+    SharingAttributes.erase(std::unique(SharingAttributes.begin(), SharingAttributes.end()), SharingAttributes.end());
+
+    /* A selector whose rightmost compounds are joined by sibling combinators can tell two
+       siblings apart by their position, so nothing carrying its subject key shares.  Sibling
+       combinators further left relate ancestors, which siblings have in common */
+    for (std::uint32_t s = 0; s < ( std::uint32_t )Sheet.Selectors.size(); ++s) {
+      const SelectorRecord &Selector = Sheet.Selectors[s];
+
+      bool SiblingSensitive = false;
+      for (std::uint32_t c = Selector.CompoundCount; c-- > 1; ) {
+        const Combinator Left = Sheet.Compounds[Selector.FirstCompound + c].LeftCombinator;
+        if (Left == Combinator::Descendant || Left == Combinator::Child)
+          break;
+        SiblingSensitive = true;
+      }
+      if (!SiblingSensitive)
+        continue;
+
+      Atom Key = NullAtom;
+      const BucketKind Kind = RuleIndex::KeyOf(Sheet, s, Key);
+      if (Kind == BucketKind::Universal)
+        AllSiblingSensitive = true;
+      else
+        SiblingSensitiveKeys.push_back(MakeFeatureKey(Kind, Key));
+    }
+    std::sort(SiblingSensitiveKeys.begin(), SiblingSensitiveKeys.end());
+  }
+
+  void RestyleEngine::BeginPass()
+  {
+    CandidateCount = 0;
+    NextCandidate = 0;
+  }
+
+  void RestyleEngine::Snapshot(const Styleable &Object, SharingCandidate &Into)
+  {
+    Into.Object = &Object;
+    Into.Parent = Object.StyleParent();
+    Into.Type = Object.Type();
+    Into.Id = Object.Id();
+    Into.Classes.clear();
+    Object.Class(Into.Classes);
+
+    Into.Attributes.resize(SharingAttributes.size());
+    Into.HasAttribute.resize(SharingAttributes.size());
+    for (std::size_t a = 0; a < SharingAttributes.size(); ++a) {
+      Into.Attributes[a] = { };
+      Into.HasAttribute[a] = Object.Attribute(Sheet.TextOf(SharingAttributes[a]), Into.Attributes[a]);
+    }
+
+    Into.Shareable = !AllSiblingSensitive && ( SiblingSensitiveKeys.empty() || !Carries(Into.Type, Into.Id, Into.Classes, SiblingSensitiveKeys) );
+  }
+
+  bool RestyleEngine::ShareStyle(const Styleable &Object)
+  {
+    Snapshot(Object, Current);
+    if (!Current.Shareable)
+      return false;
+
+    for (std::size_t i = 0; i < CandidateCount; ++i) {
+      const SharingCandidate &Candidate = Candidates[i];
+      if (Candidate.Parent != Current.Parent || Candidate.Type != Current.Type || Candidate.Id != Current.Id ||
+          Candidate.Classes != Current.Classes || Candidate.HasAttribute != Current.HasAttribute || Candidate.Attributes != Current.Attributes)
+        continue;
+
+      const ElementStyle &Style = Styles[Candidate.Object];
+      Matched.assign(Style.MatchedSelectors.begin(), Style.MatchedSelectors.end());
+      Resolved.assign(Style.Properties.begin(), Style.Properties.end());
+      ++Shared;
+      return true;
+    }
+    return false;
+  }
+
+  void RestyleEngine::RememberCandidate(const Styleable &Object)
+  {
+    if (!Current.Shareable || Current.Object != &Object)
+      return;
+
+    std::swap(Candidates[NextCandidate], Current);
+    NextCandidate = ( NextCandidate + 1 ) % Candidates.size();
+    CandidateCount = std::max(CandidateCount, NextCandidate == 0 ? Candidates.size() : NextCandidate);
+  }
+
+  const ElementStyle* RestyleEngine::StyleOf(const Styleable &Object) const
+  {
+    auto Found = Styles.find(&Object);
+    return Found == Styles.end() ? nullptr : &Found->second;
+  }
+
+  void RestyleEngine::Restyle(Styleable &Object)
+  {
+    BeginPass();
+    Resolver.BeginAncestors(Object);
+    Update(Object);
+    Resolver.EndAncestors();
+  }
+
+  void RestyleEngine::Update(Styleable &Object)
+  {
+    if (!ShareStyle(Object)) {
+      ++Restyles;
+      Resolver.Resolve(Object, Matched, Resolved);
+      RememberCandidate(Object);
+    }
+
+    ElementStyle &Style = Styles[&Object];
+    const auto &Old = Style.Properties;
+
+    auto ValueOf = [this](const ResolvedProperty &Property) { return Sheet.TextOf(Sheet.Declarations[Property.Declaration].Value); };
+
+    /* Both are sorted by property atom, so one pass finds what was added, removed or changed */
+    std::size_t o = 0, n = 0;
+    while (o < Old.size() || n < Resolved.size()) {
+      if (n == Resolved.size() || ( o < Old.size() && Old[o].Property < Resolved[n].Property )) {
+        Object.ResetProperty(Sheet.TextOf(Old[o++].Property));
+      }
+      else if (o == Old.size() || Resolved[n].Property < Old[o].Property) {
+        Resolver.ApplyResolved(Object, Resolved[n]);
+        ++n;
+      }
+      else {
+        if (Old[o].Declaration != Resolved[n].Declaration && ValueOf(Old[o]) != ValueOf(Resolved[n]))
+          Resolver.ApplyResolved(Object, Resolved[n]);
+        ++o;
+        ++n;
+      }
+    }
+
+    Style.Properties.assign(Resolved.begin(), Resolved.end());
+    Style.MatchedSelectors.assign(Matched.begin(), Matched.end());
+  }
+
+  void RestyleEngine::RestyleDescendants(Styleable &Object)
+  {
+    Styleable *Child = Object.StyleFirstChild();
+    if (!Child)
+      return;
+
+    Resolver.PushAncestor(Object);
+    for ( ; Child; Child = Child->StyleNextSibling()) {
+      Update(*Child);
+      RestyleDescendants(*Child);
+    }
+    Resolver.PopAncestor();
+  }
+
+  void RestyleEngine::RestyleDescendants(Styleable &Object, bool All, const std::vector<FeatureKey> &Keys)
+  {
+    Styleable *Child = Object.StyleFirstChild();
+    if (!Child)
+      return;
+
+    Resolver.PushAncestor(Object);
+    for ( ; Child; Child = Child->StyleNextSibling()) {
+      if (All || Carries(*Child, Keys))
+        Update(*Child);
+      RestyleDescendants(*Child, All, Keys);
+    }
+    Resolver.PopAncestor();
+  }
+
+  bool RestyleEngine::Carries(const Styleable &Object, const std::vector<FeatureKey> &Keys)
+  {
+    ClassScratch.clear();
+    Object.Class(ClassScratch);
+    return Carries(Object.Type(), Object.Id(), ClassScratch, Keys);
+  }
+
+  bool RestyleEngine::Carries(std::string_view Type, std::string_view Id, const std::vector<std::string_view> &Classes,
+                              const std::vector<FeatureKey> &Keys) const
+  {
+    auto Has = [&Keys](BucketKind Kind, Atom Name)
+    {
+      return Name != NullAtom && std::binary_search(Keys.begin(), Keys.end(), MakeFeatureKey(Kind, Name));
+    };
+
+    if (Has(BucketKind::Type, Sheet.Atoms.Find(Type)))
+      return true;
+    if (!Id.empty() && Has(BucketKind::ID, Sheet.Atoms.Find(Id)))
+      return true;
+
+    for (std::string_view Class : Classes)
+      if (Has(BucketKind::Class, Sheet.Atoms.Find(Class)))
+        return true;
+    return false;
+  }
+
+  void RestyleEngine::StyleTree(Styleable &Root)
+  {
+    BeginPass();
+    Resolver.BeginAncestors(Root);
+    Update(Root);
+    RestyleDescendants(Root);
+    Resolver.EndAncestors();
+  }
+
+  void RestyleEngine::AddInvalidation(SimpleSelectorKind Kind, std::string_view Name)
+  {
+    if (const InvalidationSet *Set = Invalidations.Find(Kind, Sheet.Atoms.Find(Name)))
+      Pending.Merge(*Set);
+  }
+
+  void RestyleEngine::Invalidate(Styleable &Object, const InvalidationSet &Set)
+  {
+    if (Set.Self)
+      Update(Object);
+
+    if (Set.AffectsDescendants())
+      RestyleDescendants(Object, Set.AllDescendants, Set.DescendantKeys);
+
+    if (Set.AffectsSiblings()) {
+      for (Styleable *Next = Object.StyleNextSibling(); Next; Next = Next->StyleNextSibling()) {
+        if (Set.AllSiblings || Carries(*Next, Set.SiblingKeys))
+          Update(*Next);
+        if (Set.SiblingDescendants)
+          RestyleDescendants(*Next, Set.AllSiblings, Set.SiblingKeys);
+      }
+    }
+  }
+
+  void RestyleEngine::ClassChanged(Styleable &Object, std::string_view Class)
+  {
+    BeginPass();
+    Pending.Clear();
+    AddInvalidation(SimpleSelectorKind::Class, Class);
+    Resolver.BeginAncestors(Object);
+    Invalidate(Object, Pending);
+    Resolver.EndAncestors();
+  }
+
+  void RestyleEngine::IdChanged(Styleable &Object, std::string_view OldId, std::string_view NewId)
+  {
+    BeginPass();
+    Pending.Clear();
+    AddInvalidation(SimpleSelectorKind::ID, OldId);
+    AddInvalidation(SimpleSelectorKind::ID, NewId);
+    Resolver.BeginAncestors(Object);
+    Invalidate(Object, Pending);
+    Resolver.EndAncestors();
+  }
+
+  void RestyleEngine::AttributeChanged(Styleable &Object, std::string_view Name)
+  {
+    BeginPass();
+    Pending.Clear();
+    AddInvalidation(SimpleSelectorKind::Attribute, Name);
+    Resolver.BeginAncestors(Object);
+    Invalidate(Object, Pending);
+    Resolver.EndAncestors();
+  }
+
+}
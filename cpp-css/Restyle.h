@@ -0,0 +1,177 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Styleable.h>
+#include <InvalidationSet.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  RestyleEngine
+//   - Keeps the resolved style (and the matched rules) of
+//     every Styleable it has styled, so that after a change
+//     it only has to restyle what the change can affect,
+//     and only calls ApplyProperty / ResetProperty for the
+//     properties whose value actually changed
+//   - Tell it what changed: ClassChanged, IdChanged or
+//     AttributeChanged.  The name's InvalidationSet says
+//     what that can restyle: nothing if no selector
+//     mentions it, the object itself if a subject compound
+//     does, and only those descendants / later siblings
+//     that carry the subject key of a selector using the
+//     name in an ancestor / sibling position
+//   - Walking trees uses Styleable::StyleFirstChild and
+//     StyleNextSibling
+//   - Siblings that are provably equivalent share a style
+//     instead of each being matched: same parent, same
+//     type, id and classes, the same values for every
+//     attribute the sheet's selectors look at, and no
+//     selector that could tell them apart by position.
+//     The last few styled objects are kept as candidates,
+//     for the length of one call into the engine
+//   - Keeps an AncestorFilter of the path down to the
+//     object being matched, so selectors needing an
+//     ancestor the path doesn't have are rejected without
+//     walking up the tree
+//   - Call Forget() before destroying an object it styled
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  struct ElementStyle
+  {
+    std::vector<std::uint32_t>    MatchedSelectors;
+    std::vector<ResolvedProperty> Properties;
+  };
+
+  class RestyleEngine
+  {
+  public:
+
+    explicit RestyleEngine(const Stylesheet &Sheet);
+
+    /* Styles Root and everything below it */
+    void StyleTree(Styleable &Root);
+
+    /* Restyles just Object */
+    void Restyle(Styleable &Object);
+
+    /* Call after adding or removing Class on Object */
+    void ClassChanged(Styleable &Object, std::string_view Class);
+    void IdChanged(Styleable &Object, std::string_view OldId, std::string_view NewId);
+    void AttributeChanged(Styleable &Object, std::string_view Name);
+
+    void Forget(const Styleable &Object) { Styles.erase(&Object); }
+
+    /* nullptr if the engine hasn't styled Object */
+    const ElementStyle* StyleOf(const Styleable &Object) const;
+
+    /* How many times an object's style has been matched and cascaded */
+    std::size_t RestyleCount() const { return Restyles; }
+
+    /* How many times an object's style was taken from an equivalent sibling instead */
+    std::size_t SharedCount() const { return Shared; }
+
+    /* How many selectors were ruled out by the ancestor filter instead of walking up the tree */
+    std::size_t FilterRejections() const { return Resolver.FilterRejections(); }
+
+    const MatchedDeclarationsCache& DeclarationCache() const { return Resolver.DeclarationCache(); }
+
+  private:
+
+    static constexpr std::size_t MaxSharingCandidates = 8;
+
+    /* What has to be equal for two objects to share a style */
+    struct SharingCandidate
+    {
+      const Styleable              *Object = nullptr;
+      const Styleable              *Parent = nullptr;
+      std::string_view              Type, Id;
+      std::vector<std::string_view> Classes;
+      std::vector<std::string_view> Attributes;
+      std::vector<bool>             HasAttribute;
+      bool                          Shareable = false;
+    };
+
+    void BeginPass();
+    void Update(Styleable &Object);
+
+    void Snapshot(const Styleable &Object, SharingCandidate &Into);
+    bool ShareStyle(const Styleable &Object);
+    void RememberCandidate(const Styleable &Object);
+
+    void AddInvalidation(SimpleSelectorKind Kind, std::string_view Name);
+    void Invalidate(Styleable &Object, const InvalidationSet &Set);
+    void RestyleDescendants(Styleable &Object);
+
+    /* Restyles Object's descendants that carry one of Keys, or all of them */
+    void RestyleDescendants(Styleable &Object, bool All, const std::vector<FeatureKey> &Keys);
+    bool Carries(const Styleable &Object, const std::vector<FeatureKey> &Keys);
+    bool Carries(std::string_view Type, std::string_view Id, const std::vector<std::string_view> &Classes,
+                 const std::vector<FeatureKey> &Keys) const;
+
+    const Stylesheet                                   &Sheet;
+    StyleResolver                                       Resolver;
+    InvalidationSets                                    Invalidations;
+    InvalidationSet                                     Pending;
+    std::vector<std::string_view>                       ClassScratch;
+
+    std::vector<Atom>                                   SharingAttributes;
+    std::vector<FeatureKey>                             SiblingSensitiveKeys;
+    bool                                                AllSiblingSensitive = false;
+    std::vector<SharingCandidate>                       Candidates;
+    std::size_t                                         CandidateCount = 0, NextCandidate = 0;
+    SharingCandidate                                    Current;
+
+    std::unordered_map<const Styleable*, ElementStyle>  Styles;
+    std::vector<std::uint32_t>                          Matched;
+    std::vector<ResolvedProperty>                       Resolved;
+    std::size_t                                         Restyles = 0, Shared = 0;
+  };
+
+}
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <RuleIndex.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  BucketKind RuleIndex::KeyOf(const Stylesheet &Sheet, std::uint32_t Selector, Atom &Key)
+  {
+    const SelectorRecord &Record = Sheet.Selectors[Selector];
+    const CompoundRecord &Rightmost = Sheet.Compounds[Record.FirstCompound + Record.CompoundCount - 1];
+
+    Atom ClassKey = NullAtom, TypeKey = NullAtom;
+
+    for (std::uint32_t s = Rightmost.FirstSimple; s < Rightmost.FirstSimple + Rightmost.SimpleCount; ++s) {
+      const SimpleSelectorRecord &Simple = Sheet.SimpleSelectors[s];
+
+      if (Simple.Kind == SimpleSelectorKind::ID) {
+        Key = Simple.Name;
+        return BucketKind::ID;
+      }
+      if (Simple.Kind == SimpleSelectorKind::Class && ClassKey == NullAtom)
+        ClassKey = Simple.Name;
+      if (Simple.Kind == SimpleSelectorKind::Type)
+        TypeKey = Simple.Name;
+    }
+
+    Key = ClassKey != NullAtom ? ClassKey : TypeKey;
+
+    if (ClassKey != NullAtom)
+      return BucketKind::Class;
+    if (TypeKey != NullAtom)
+      return BucketKind::Type;
+    return BucketKind::Universal;
+  }
+
+  void RuleIndex::Build(const Stylesheet &Sheet)
+  {
+    const std::size_t AtomCount = Sheet.Atoms.Size();
+    const auto SelectorCount = ( std::uint32_t )Sheet.Selectors.size();
+
+    /* Counting sort: count each bucket, turn the counts into offsets, then drop every
+       selector into place in cascade order, which each bucket then keeps */
+    std::vector<BucketKind> Kinds(SelectorCount);
+    std::vector<Atom> Keys(SelectorCount);
+    std::vector<std::uint32_t> Counts(AtomCount * 3 + 1, 0);
+
+    auto Slot = [AtomCount](BucketKind Kind, Atom Key) -> std::size_t
+    {
+      return Kind == BucketKind::Universal ? AtomCount * 3 : ( std::size_t )Kind * AtomCount + Key;
+    };
+
+    for (std::uint32_t s = 0; s < SelectorCount; ++s) {
+      Kinds[s] = KeyOf(Sheet, s, Keys[s]);
+      ++Counts[Slot(Kinds[s], Keys[s])];
+    }
+
+    std::vector<std::uint32_t> Starts(Counts.size() + 1, 0);
+    for (std::size_t i = 0; i < Counts.size(); ++i)
+      Starts[i + 1] = Starts[i] + Counts[i];
+
+    std::vector<std::uint32_t> Order;
+    Sheet.CascadeOrder(Order);
+
+    Entries.assign(SelectorCount, 0);
+    std::vector<std::uint32_t> Fill(Starts.begin(), Starts.end() - 1);
+    for (std::uint32_t s : Order)
+      Entries[Fill[Slot(Kinds[s], Keys[s])]++] = s;
+
+    IDStarts.assign(Starts.begin(), Starts.begin() + AtomCount + 1);
+    ClassStarts.assign(Starts.begin() + AtomCount, Starts.begin() + AtomCount * 2 + 1);
+    TypeStarts.assign(Starts.begin() + AtomCount * 2, Starts.begin() + AtomCount * 3 + 1);
+    UniversalStart = Starts[AtomCount * 3];
+  }
+
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Stylesheet.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  RuleIndex
+//   - Answers "which selectors could possibly match this
+//     element" without looking at every selector
+//   - Each selector goes into exactly one bucket, keyed by
+//     the most selective part of its rightmost compound:
+//     its id, else its first class, else its type, else
+//     the universal bucket
+//   - An element only has to look in the bucket for its
+//     id, one bucket per class, the bucket for its tag and
+//     the universal bucket.  Everything it finds there is
+//     a candidate that still has to be matched properly
+//   - Every bucket is sorted in cascade order (specificity,
+//     then source order), so the matches from several
+//     buckets only need merging, never sorting
+//   - Buckets are stored back to back in one array and
+//     found through per-atom offset tables, so a lookup is
+//     two array reads and no hashing
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  /* An element's keys, already looked up in the sheet's AtomTable.
+     Names the sheet never mentions are NullAtom and can't match anything */
+  struct ElementKeys
+  {
+    Atom        Tag = NullAtom;
+    Atom        Id = NullAtom;
+    const Atom *Classes = nullptr;
+    std::size_t ClassCount = 0;
+  };
+
+  /* A contiguous run of selector indices */
+  struct RuleBucket
+  {
+    const std::uint32_t *First = nullptr;
+    const std::uint32_t *Last = nullptr;
+
+    const std::uint32_t *begin() const { return First; }
+    const std::uint32_t *end() const { return Last; }
+    std::size_t size() const { return ( std::size_t )( Last - First ); }
+    bool empty() const { return First == Last; }
+  };
+
+  enum class BucketKind : std::uint8_t
+  {
+    ID,
+    Class,
+    Type,
+    Universal
+  };
+
+  class RuleIndex
+  {
+  public:
+
+    RuleIndex() = default;
+    explicit RuleIndex(const Stylesheet &Sheet) { Build(Sheet); }
+
+    void Build(const Stylesheet &Sheet);
+
+    /* Which bucket (and under which atom) a selector was filed */
+    static BucketKind KeyOf(const Stylesheet &Sheet, std::uint32_t Selector, Atom &Key);
+
+    RuleBucket IDBucket(Atom Id) const { return Bucket(IDStarts, Id); }
+    RuleBucket ClassBucket(Atom Class) const { return Bucket(ClassStarts, Class); }
+    RuleBucket TypeBucket(Atom Tag) const { return Bucket(TypeStarts, Tag); }
+    RuleBucket UniversalBucket() const { return { Entries.data() + UniversalStart, Entries.data() + Entries.size() }; }
+
+    /* Calls Visit(SelectorIndex) for every candidate selector, one bucket after another */
+    template <class Visitor>
+    void ForEachCandidate(const ElementKeys &Keys, Visitor &&Visit) const
+    {
+      for (auto Selector : IDBucket(Keys.Id))
+        Visit(Selector);
+      for (std::size_t c = 0; c < Keys.ClassCount; ++c)
+        for (auto Selector : ClassBucket(Keys.Classes[c]))
+          Visit(Selector);
+      for (auto Selector : TypeBucket(Keys.Tag))
+        Visit(Selector);
+      for (auto Selector : UniversalBucket())
+        Visit(Selector);
+    }
+
+    void CollectCandidates(const ElementKeys &Keys, std::vector<std::uint32_t> &Out) const
+    {
+      ForEachCandidate(Keys, [&Out](std::uint32_t Selector) { Out.push_back(Selector); });
+    }
+
+  private:
+
+    RuleBucket Bucket(const std::vector<std::uint32_t> &Starts, Atom Key) const
+    {
+      if (Key == NullAtom || Key + 1 >= Starts.size())
+        return { };
+      return { Entries.data() + Starts[Key], Entries.data() + Starts[Key + 1] };
+    }
+
+    /* Entries holds every id bucket (in atom order), then every class bucket, then
+       every type bucket, then the universal bucket.  XStarts[a]..XStarts[a + 1] is
+       atom a's bucket of kind X */
+    std::vector<std::uint32_t> Entries;
+    std::vector<std::uint32_t> IDStarts;
+    std::vector<std::uint32_t> ClassStarts;
+    std::vector<std::uint32_t> TypeStarts;
+    std::uint32_t              UniversalStart = 0;
+  };
+
+}
@@ -0,0 +1,411 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Scanner.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CSS_SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(CSS_SCANNER_X86) && !defined(_MSC_VER)
+#define CSS_TARGET_SSE2 __attribute__((target("sse2")))
+#define CSS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CSS_TARGET_SSE2
+#define CSS_TARGET_AVX2
+#endif
+
+namespace css
+{
+
+  namespace
+  {
+
+    __forceinline unsigned CountTrailingZeros(std::uint32_t Mask)
+    {
+#ifdef _MSC_VER
+      unsigned long Index;
+      _BitScanForward(&Index, Mask);
+      return ( unsigned )Index;
+#else
+      return ( unsigned )__builtin_ctz(Mask);
+#endif
+    }
+
+    /************************************************************************/
+    /* Byte classes                                                         */
+    /*   Each class knows how to test one byte, 16 bytes and 32 bytes.      */
+    /*   Vector tests produce 0xFF in every lane that is in the class.      */
+    /************************************************************************/
+    struct WhitespaceClass
+    {
+      static bool Scalar(unsigned char c) { return IsWhitespaceByte(c); }
+
+#ifdef CSS_SCANNER_X86
+      /* ' ' or '\t'..'\r' - the range test is (c - '\t') <= 4 done with a saturating subtract */
+      CSS_TARGET_SSE2 static __m128i SSE2(__m128i v)
+      {
+        __m128i Space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+        __m128i Shift = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+        __m128i Range = _mm_cmpeq_epi8(_mm_subs_epu8(Shift, _mm_set1_epi8(4)), _mm_setzero_si128());
+        return _mm_or_si128(Space, Range);
+      }
+
+      CSS_TARGET_AVX2 static __m256i AVX2(__m256i v)
+      {
+        __m256i Space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+        __m256i Shift = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+        __m256i Range = _mm256_cmpeq_epi8(_mm256_subs_epu8(Shift, _mm256_set1_epi8(4)), _mm256_setzero_si256());
+        return _mm256_or_si256(Space, Range);
+      }
+#endif
+    };
+
+    struct IdentifierClass
+    {
+      static bool Scalar(unsigned char c) { return IsIdentifierByte(c); }
+
+#ifdef CSS_SCANNER_X86
+      /* Folding to lower case with | 0x20 lets one range test cover both cases of alpha */
+      CSS_TARGET_SSE2 static __m128i SSE2(__m128i v)
+      {
+        __m128i Lower = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        __m128i Alpha = _mm_cmpeq_epi8(_mm_subs_epu8(Lower, _mm_set1_epi8(25)), _mm_setzero_si128());
+        __m128i Digits = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        __m128i Digit = _mm_cmpeq_epi8(_mm_subs_epu8(Digits, _mm_set1_epi8(9)), _mm_setzero_si128());
+        __m128i Dash = _mm_cmpeq_epi8(v, _mm_set1_epi8('-'));
+        return _mm_or_si128(_mm_or_si128(Alpha, Digit), Dash);
+      }
+
+      CSS_TARGET_AVX2 static __m256i AVX2(__m256i v)
+      {
+        __m256i Lower = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i Alpha = _mm256_cmpeq_epi8(_mm256_subs_epu8(Lower, _mm256_set1_epi8(25)), _mm256_setzero_si256());
+        __m256i Digits = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        __m256i Digit = _mm256_cmpeq_epi8(_mm256_subs_epu8(Digits, _mm256_set1_epi8(9)), _mm256_setzero_si256());
+        __m256i Dash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'));
+        return _mm256_or_si256(_mm256_or_si256(Alpha, Digit), Dash);
+      }
+#endif
+    };
+
+    struct StructuralClass
+    {
+      static bool Scalar(unsigned char c) { return IsStructuralByte(c); }
+
+#ifdef CSS_SCANNER_X86
+      /* '(' and ')' differ only in bit 0, and clearing bit 5 folds '{' '}' onto '[' ']', so
+         the eleven bytes take eight compares */
+      CSS_TARGET_SSE2 static __m128i SSE2(__m128i v)
+      {
+        __m128i Folded = _mm_and_si128(v, _mm_set1_epi8(( char )0xDF));
+        __m128i Paren = _mm_cmpeq_epi8(_mm_or_si128(v, _mm_set1_epi8(1)), _mm_set1_epi8(')'));
+        __m128i Open = _mm_cmpeq_epi8(Folded, _mm_set1_epi8('['));
+        __m128i Close = _mm_cmpeq_epi8(Folded, _mm_set1_epi8(']'));
+        __m128i Semi = _mm_cmpeq_epi8(v, _mm_set1_epi8(';'));
+        __m128i Double = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+        __m128i Single = _mm_cmpeq_epi8(v, _mm_set1_epi8('\''));
+        __m128i Escape = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+        __m128i Newline = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+        __m128i Brackets = _mm_or_si128(_mm_or_si128(Paren, Open), _mm_or_si128(Close, Semi));
+        __m128i Strings = _mm_or_si128(_mm_or_si128(Double, Single), _mm_or_si128(Escape, Newline));
+        return _mm_or_si128(Brackets, Strings);
+      }
+
+      CSS_TARGET_AVX2 static __m256i AVX2(__m256i v)
+      {
+        __m256i Folded = _mm256_and_si256(v, _mm256_set1_epi8(( char )0xDF));
+        __m256i Paren = _mm256_cmpeq_epi8(_mm256_or_si256(v, _mm256_set1_epi8(1)), _mm256_set1_epi8(')'));
+        __m256i Open = _mm256_cmpeq_epi8(Folded, _mm256_set1_epi8('['));
+        __m256i Close = _mm256_cmpeq_epi8(Folded, _mm256_set1_epi8(']'));
+        __m256i Semi = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(';'));
+        __m256i Double = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+        __m256i Single = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''));
+        __m256i Escape = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+        __m256i Newline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+        __m256i Brackets = _mm256_or_si256(_mm256_or_si256(Paren, Open), _mm256_or_si256(Close, Semi));
+        __m256i Strings = _mm256_or_si256(_mm256_or_si256(Double, Single), _mm256_or_si256(Escape, Newline));
+        return _mm256_or_si256(Brackets, Strings);
+      }
+#endif
+    };
+
+    /************************************************************************/
+    /* Scan loops                                                           */
+    /*   StopInside == false: stop at the first byte NOT in the class       */
+    /*   StopInside == true:  stop at the first byte that IS in the class   */
+    /************************************************************************/
+    template <class Class, bool StopInside>
+    const char *ScanScalar(const char *First, const char *Last)
+    {
+      while (First != Last && Class::Scalar(( unsigned char )*First) != StopInside)
+        ++First;
+      return First;
+    }
+
+#ifdef CSS_SCANNER_X86
+    template <class Class, bool StopInside>
+    CSS_TARGET_SSE2 const char *ScanSSE2(const char *First, const char *Last)
+    {
+      while (Last - First >= 16) {
+        __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(First));
+        std::uint32_t Mask = ( std::uint32_t )_mm_movemask_epi8(Class::SSE2(Bytes));
+        if (!StopInside)
+          Mask = ~Mask & 0xFFFFu;
+        if (Mask)
+          return First + CountTrailingZeros(Mask);
+        First += 16;
+      }
+      return ScanScalar<Class, StopInside>(First, Last);
+    }
+
+    template <class Class, bool StopInside>
+    CSS_TARGET_AVX2 const char *ScanAVX2(const char *First, const char *Last)
+    {
+      while (Last - First >= 32) {
+        __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(First));
+        std::uint32_t Mask = ( std::uint32_t )_mm256_movemask_epi8(Class::AVX2(Bytes));
+        if (!StopInside)
+          Mask = ~Mask;
+        if (Mask)
+          return First + CountTrailingZeros(Mask);
+        First += 32;
+      }
+      return ScanSSE2<Class, StopInside>(First, Last);
+    }
+#endif
+
+    struct ScannerTable
+    {
+      const char *( *Whitespace )( const char *, const char * );
+      const char *( *Identifier )( const char *, const char * );
+      const char *( *Structural )( const char *, const char * );
+    };
+
+    const ScannerTable ScalarTable = {
+      ScanScalar<WhitespaceClass, false>,
+      ScanScalar<IdentifierClass, false>,
+      ScanScalar<StructuralClass, true>
+    };
+
+#ifdef CSS_SCANNER_X86
+    const ScannerTable SSE2Table = {
+      ScanSSE2<WhitespaceClass, false>,
+      ScanSSE2<IdentifierClass, false>,
+      ScanSSE2<StructuralClass, true>
+    };
+
+    const ScannerTable AVX2Table = {
+      ScanAVX2<WhitespaceClass, false>,
+      ScanAVX2<IdentifierClass, false>,
+      ScanAVX2<StructuralClass, true>
+    };
+#endif
+
+    const ScannerTable &TableFor(ScannerLevel Level)
+    {
+#ifdef CSS_SCANNER_X86
+      switch (Level)
+      {
+        case ScannerLevel::AVX2: return AVX2Table;
+        case ScannerLevel::SSE2: return SSE2Table;
+        default:                 break;
+      }
+#endif
+      return ScalarTable;
+    }
+
+    std::atomic<const ScannerTable *> &ActiveTable()
+    {
+      static std::atomic<const ScannerTable *> Table{ &TableFor(DetectScannerLevel()) };
+      return Table;
+    }
+
+    __forceinline const ScannerTable &Active()
+    {
+      return *ActiveTable().load(std::memory_order_relaxed);
+    }
+
+  }
+
+  ScannerLevel DetectScannerLevel()
+  {
+#if defined(CSS_SCANNER_X86) && defined(_MSC_VER)
+    int Info[4];
+    __cpuid(Info, 0);
+    const int MaxLeaf = Info[0];
+
+    __cpuid(Info, 1);
+    const bool HasSSE2 = ( Info[3] & ( 1 << 26 ) ) != 0;
+    const bool HasOSXSave = ( Info[2] & ( 1 << 27 ) ) != 0;
+    const bool HasAVX = ( Info[2] & ( 1 << 28 ) ) != 0;
+
+    /* AVX2 also needs the OS to save the upper halves of the ymm registers */
+    if (MaxLeaf >= 7 && HasOSXSave && HasAVX && ( _xgetbv(0) & 0x6 ) == 0x6) {
+      __cpuidex(Info, 7, 0);
+      if (Info[1] & ( 1 << 5 ))
+        return ScannerLevel::AVX2;
+    }
+
+    return HasSSE2 ? ScannerLevel::SSE2 : ScannerLevel::Scalar;
+#elif defined(CSS_SCANNER_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return ScannerLevel::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+      return ScannerLevel::SSE2;
+    return ScannerLevel::Scalar;
+#else
+    return ScannerLevel::Scalar;
+#endif
+  }
+
+  ScannerLevel ActiveScannerLevel()
+  {
+    const ScannerTable *Table = ActiveTable().load(std::memory_order_relaxed);
+#ifdef CSS_SCANNER_X86
+    if (Table == &AVX2Table)
+      return ScannerLevel::AVX2;
+    if (Table == &SSE2Table)
+      return ScannerLevel::SSE2;
+#endif
+    return ScannerLevel::Scalar;
+  }
+
+  bool SetScannerLevel(ScannerLevel Level)
+  {
+    if (Level > DetectScannerLevel())
+      return false;
+
+    ActiveTable().store(&TableFor(Level), std::memory_order_relaxed);
+    return true;
+  }
+
+  const char *ScanWhitespace(const char *First, const char *Last)
+  {
+    return Active().Whitespace(First, Last);
+  }
+
+  const char *ScanIdentifier(const char *First, const char *Last)
+  {
+    return Active().Identifier(First, Last);
+  }
+
+  const char *ScanStructural(const char *First, const char *Last)
+  {
+    return Active().Structural(First, Last);
+  }
+
+  /* memchr is already vectorized by every C runtime we build against */
+  const char *ScanUntil(const char *First, const char *Last, char Delim)
+  {
+    const void *Found = First != Last ? memchr(First, Delim, ( std::size_t )( Last - First )) : nullptr;
+    return Found ? static_cast<const char *>(Found) : Last;
+  }
+
+  /* Only the bytes ScanStructural stops at can change the nesting, so everything between them
+     (most of a long data: URI) is skipped a vector at a time.  A string ends at its quote or,
+     as CSS has it, at an unescaped newline */
+  const char *ScanValue(const char *First, const char *Last)
+  {
+    const auto Scan = Active().Structural;
+    int Depth = 0;
+    char Quote = 0;
+
+    for (First = Scan(First, Last); First != Last; First = Scan(First + 1, Last)) {
+      const char c = *First;
+
+      if (c == '\\') {
+        if (First + 1 != Last)
+          ++First;
+        continue;
+      }
+
+      if (Quote) {
+        if (c == Quote || c == '\n')
+          Quote = 0;
+        continue;
+      }
+
+      switch (c)
+      {
+        case '"':
+        case '\'':
+          Quote = c;
+          break;
+
+        case '(':
+        case '[':
+        case '{':
+          ++Depth;
+          break;
+
+        case ')':
+        case ']':
+          Depth -= Depth > 0;
+          break;
+
+        case '}':
+          if (Depth == 0)
+            return First;
+          --Depth;
+          break;
+
+        case ';':
+          if (Depth == 0)
+            return First;
+          break;
+
+        default:
+          break;
+      }
+    }
+
+    return Last;
+  }
+
+}
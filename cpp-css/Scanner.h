@@ -0,0 +1,109 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+//  Scanners
+//   - Classify runs of bytes in a contiguous buffer
+//     16 (SSE2) or 32 (AVX2) at a time instead of one
+//     per iteration
+//   - The widest instruction set the CPU supports is
+//     picked once at runtime; everything else falls back
+//     to the scalar loops
+//   - Every scanner returns a pointer to the first byte
+//     that ends the run, or Last if the run reaches the
+//     end of the buffer.  Nothing past Last is ever read
+//
+//     ScanWhitespace - skips ' ', \t, \n, \v, \f, \r
+//     ScanIdentifier - skips [A-Za-z0-9-]
+//     ScanStructural - stops at ; { } ( ) [ ] " ' \ and \n
+//     ScanUntil      - stops at Delim
+//     ScanValue      - stops at the ; or } that ends a
+//                      declaration value, stepping over
+//                      brackets, strings and escapes
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  enum class ScannerLevel
+  {
+    Scalar,
+    SSE2,
+    AVX2
+  };
+
+  /* The best level this CPU supports */
+  ScannerLevel DetectScannerLevel();
+
+  /* The level currently used by the scanners */
+  ScannerLevel ActiveScannerLevel();
+
+  /* Forces a level (ie for testing or benchmarking).  Returns false if the CPU doesn't support it */
+  bool SetScannerLevel(ScannerLevel Level);
+
+  const char *ScanWhitespace(const char *First, const char *Last);
+  const char *ScanIdentifier(const char *First, const char *Last);
+  const char *ScanStructural(const char *First, const char *Last);
+  const char *ScanUntil(const char *First, const char *Last, char Delim);
+  const char *ScanValue(const char *First, const char *Last);
+
+  /* Scalar classification, matching the "C" locale */
+  __forceinline bool IsWhitespaceByte(int c) { return c == ' ' || ( unsigned )( c - '\t' ) <= 4u; }
+  __forceinline bool IsIdentifierByte(int c) { return ( unsigned )( ( c | 0x20 ) - 'a' ) <= 25u || ( unsigned )( c - '0' ) <= 9u || c == '-'; }
+  __forceinline bool IsDigitByte(int c) { return ( unsigned )( c - '0' ) <= 9u; }
+
+  /* Names inside values also take '_' and anything outside ASCII */
+  __forceinline bool IsNameStartByte(int c) { return ( unsigned )( ( c | 0x20 ) - 'a' ) <= 25u || c == '_' || c >= 0x80; }
+  __forceinline bool IsNameByte(int c) { return IsIdentifierByte(c) || c == '_' || c >= 0x80; }
+
+  /* Every byte that can open or close a bracket or string, or end a value */
+  __forceinline bool IsStructuralByte(int c)
+  {
+    return c == ';' || c == '{' || c == '}' || c == '(' || c == ')' || c == '[' || c == ']' ||
+           c == '"' || c == '\'' || c == '\\' || c == '\n';
+  }
+
+}
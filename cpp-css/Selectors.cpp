@@ -44,21 +44,240 @@
 namespace css
 {
 
+  /************************************************************************/
+  /* Parser cores                                                         */
+  /*   Each parser is written once here against the cursor interface in   */
+  /*   Cursor.h.  The istream overloads run these over a StreamCursor and */
+  /*   the buffer overloads over a BufferCursor, so both paths accept     */
+  /*   exactly the same input.                                            */
+  /*   Every parser checkpoints the cursor on entry and rewinds to it     */
+  /*   before returning false, so a failed attempt consumes nothing.      */
+  /*   The exception is a declaration block missing its '}', which keeps  */
+  /*   what it read, as it always has.                                    */
+  /************************************************************************/
+  namespace
+  {
+
+    /* Identifiers must start with an alpha, then can be any alpha, number, or '-' */
+    template <class CursorType>
+    bool ParseIdentifier(CursorType &Input, typename CursorType::TextType &Text)
+    {
+      if (!isalpha(Input.Peek()))
+        return false;
+
+      auto Start = Input.Mark();
+      Input.Ignore();
+      Input.SkipIdentifier();
+
+      Text = Input.Slice(Start);
+      return true;
+    }
+
+    template <class CursorType>
+    bool ParseAlphaRun(CursorType &Input, typename CursorType::TextType &Text)
+    {
+      auto Saved = Input.Save();
+      Input.SkipWhitespace();
+
+      if (!isalpha(Input.Peek())) {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      auto Start = Input.Mark();
+      while (isalpha(Input.Peek()))
+        Input.Ignore();
+
+      Text = Input.Slice(Start);
+      return true;
+    }
+
+    template <class CursorType>
+    bool ParseType(CursorType &Input, typename CursorType::TextType &Text)
+    {
+      if (!Input.Good())
+        REPORT_DIAGNOSTIC_AND_RETURN(Input, InvalidSource, false);
+
+      auto Saved = Input.Save();
+      Input.SkipWhitespace();
+
+      if (!ParseIdentifier(Input, Text)) {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      return true;
+    }
+
+    /* Shared by class and id selectors - a single prefix character followed by an identifier */
+    template <class CursorType>
+    bool ParsePrefixedIdentifier(CursorType &Input, char Prefix, typename CursorType::TextType &Text)
+    {
+      if (!Input.Good())
+        REPORT_DIAGNOSTIC_AND_RETURN(Input, InvalidSource, false);
+
+      auto Saved = Input.Save();
+      Input.SkipWhitespace();
+
+      if (Input.Peek() != Prefix) {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      Input.Ignore();
+
+      if (!ParseIdentifier(Input, Text)) {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      return true;
+    }
+
+    template <class CursorType>
+    bool ParseAttribute(CursorType &Input, typename CursorType::TextType &Attr,
+                        typename CursorType::TextType &Comp, typename CursorType::TextType &Val)
+    {
+      using TextType = typename CursorType::TextType;
+
+      if (!Input.Good())
+        REPORT_DIAGNOSTIC_AND_RETURN(Input, InvalidSource, false);
+
+      if (Input.Peek() != '[')
+        return false;
+
+      auto Saved = Input.Save();
+      Input.Ignore();
+
+      TextType TempAttr{ }, TempComp{ }, TempVal{ };
+
+      if (!ParseAlphaRun(Input, TempAttr)) {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      auto CompStart = Input.Mark();
+      int c = Input.Peek();
+      while (c == '=' || ( c != std::char_traits<char>::eof() && IsOneOf(( char )c, "|^$~*") )) {
+        Input.Ignore();
+        c = Input.Peek();
+      }
+      TempComp = Input.Slice(CompStart);
+
+      if (TempComp.empty() || TempComp.size() > 2 || !ParseAlphaRun(Input, TempVal) || Input.Peek() != ']') {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      Input.Ignore();
+
+      Attr = TempAttr;
+      Comp = TempComp;
+      Val = TempVal;
+      return true;
+    }
+
+    /* Works for both the owned and the viewed text types */
+    template <class TextType>
+    TextType TrimTrailingWhitespace(const TextType &Text)
+    {
+      std::size_t Length = Text.size();
+      while (Length != 0 && IsWhitespaceByte(( unsigned char )Text[Length - 1]))
+        --Length;
+      return Text.substr(0, Length);
+    }
+
+    template <class CursorType>
+    bool ParseDeclaration(CursorType &Input, typename CursorType::TextType &Property,
+                          typename CursorType::TextType &Value, PropertyId &Id)
+    {
+      if (!Input.Good())
+        return false;
+
+      typename CursorType::TextType Prop{ };
+
+      auto Saved = Input.Save();
+      Input.SkipWhitespace();
+
+      if (!ParseIdentifier(Input, Prop) || Input.Peek() != ':') {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      Input.Ignore();
+      Input.SkipWhitespace();
+
+      /* A ';' or '}' inside brackets or a string (ie url("data:...;base64,...")) doesn't end the value,
+         and a '}' after the last declaration is left for the block */
+      auto ValStart = Input.Mark();
+      Input.SkipValue();
+      Value = TrimTrailingWhitespace(Input.Slice(ValStart));
+
+      if (Input.Peek() == ';')
+        Input.Ignore();
+
+      Property = Prop;
+      Id = LookupProperty(Property);
+      return true;
+    }
+
+    template <class CursorType, class RuleList>
+    bool ParseDeclarationBlock(CursorType &Input, RuleList &Rules)
+    {
+      using DeclarationType = typename RuleList::value_type;
+
+      if (!Input.Good())
+        return false;
+
+      auto Saved = Input.Save();
+      Input.SkipWhitespace();
+
+      if (Input.Peek() != '{') {
+        Input.Rewind(Saved);
+        return false;
+      }
+
+      Input.Ignore();
+
+      while (true) {
+        Input.SkipWhitespace();
+
+        if (Input.Peek() == '}')
+          break;
+
+        DeclarationType decl;
+        if (!ParseDeclaration(Input, decl.PropertyText, decl.ValueText, decl.Id)) {
+          Input.Report(DiagnosticCode::InvalidDeclaration);
+          break;
+        }
+
+        Rules.push_back(std::move(decl));
+      }
+
+      //Ignore anything remaining until we either run out of input (return false) or reach the closing brace
+      for (Input.SkipValue(); Input.Peek() == ';'; Input.SkipValue())
+        Input.Ignore();
+
+      /* The one parser that doesn't rewind: a block that runs out of input fails, but keeps the
+         declarations it did read and leaves the input at its end */
+      if (Input.Peek() != '}') {
+        Input.Report(DiagnosticCode::UnterminatedBlock);
+        return false;
+      }
+
+      Input.Ignore();
+      return true;
+    }
+
+  }
+
   inline bool operator>>(std::istream &Input, StringParser &Parser)
   {
     if (!Input)
       return false;
-    IgnoreWhitespace(Input);
-
-    if (!Input.peek() || !isalpha(Input.peek()))
-      return false;
-
-    std::string Temp = "";
-    while (Input && isalpha(Input.peek()))
-      Temp += Input.get();
 
-    Parser.Text = Temp;
-    return true;
+    StreamCursor Cursor(Input);
+    return ParseAlphaRun(Cursor, Parser.Text);
   }
 
   /************************************************************************/
@@ -66,28 +285,31 @@ namespace css
   /************************************************************************/
   bool TypeSelector::ParseFromInput(std::istream &Input)
   {
-    if (!Input)
-      REPORT_IO_SOURCE_INVALID_AND_RETURN(false);
-
-    /* ID elements must start with an alpha, then can be any alpha, number, or '-' */
-    IgnoreWhitespace(Input);
-
-    std::string Temp = "";
+    StreamCursor Cursor(Input);
+    return ParseType(Cursor, Text);
+  }
 
-    if (!isalpha(Input.peek())) {
+  bool TypeSelector::ParseFromBuffer(BufferCursor &Input)
+  {
+    TypeSelectorView View;
+    if (!View.ParseFromBuffer(Input))
       return false;
-    }
 
-    Temp += ( char )Input.get();
-    char c = ( char )Input.peek();
+    *this = View.Materialize();
+    return true;
+  }
 
-    while (Input && ( isalnum(c) || c == '-' )) {
-      Temp += ( char )Input.get();
-      c = ( char )Input.peek();
-    }
+  template <class SinkType>
+  bool TypeSelectorView::ParseFromBuffer(BasicBufferCursor<SinkType> &Input)
+  {
+    return ParseType(Input, Text);
+  }
 
-    Text = Temp;
-    return true;
+  TypeSelector TypeSelectorView::Materialize() const
+  {
+    TypeSelector Selector;
+    Selector.Text = std::string(Text);
+    return Selector;
   }
 
   /************************************************************************/
@@ -95,25 +317,31 @@ namespace css
   /************************************************************************/
   bool ClassSelector::ParseFromInput(std::istream &Input)
   {
-    if (!Input)
-      REPORT_IO_SOURCE_INVALID_AND_RETURN(false);
-
-    IgnoreWhitespace(Input);
+    StreamCursor Cursor(Input);
+    return ParsePrefixedIdentifier(Cursor, '.', Text);
+  }
 
-    if (( char )Input.peek() != '.')
+  bool ClassSelector::ParseFromBuffer(BufferCursor &Input)
+  {
+    ClassSelectorView View;
+    if (!View.ParseFromBuffer(Input))
       return false;
 
-    Input.ignore();
+    *this = View.Materialize();
+    return true;
+  }
 
-    TypeSelector ClassName;
-    if (!( Input >> ClassName )) {
-      Input.putback('.');
-      return false;
-      return false;
-    }
+  template <class SinkType>
+  bool ClassSelectorView::ParseFromBuffer(BasicBufferCursor<SinkType> &Input)
+  {
+    return ParsePrefixedIdentifier(Input, '.', Text);
+  }
 
-    Text = ClassName.Text;
-    return true;
+  ClassSelector ClassSelectorView::Materialize() const
+  {
+    ClassSelector Selector;
+    Selector.Text = std::string(Text);
+    return Selector;
   }
 
   /************************************************************************/
@@ -121,25 +349,31 @@ namespace css
   /************************************************************************/
   bool IDSelector::ParseFromInput(std::istream &Input)
   {
-    if (!Input)
-      REPORT_IO_SOURCE_INVALID_AND_RETURN(false);
-
-    IgnoreWhitespace(Input);
+    StreamCursor Cursor(Input);
+    return ParsePrefixedIdentifier(Cursor, '#', Text);
+  }
 
-    if (( char )Input.peek() != '#')
+  bool IDSelector::ParseFromBuffer(BufferCursor &Input)
+  {
+    IDSelectorView View;
+    if (!View.ParseFromBuffer(Input))
       return false;
 
-    Input.ignore();
+    *this = View.Materialize();
+    return true;
+  }
 
-    TypeSelector IDName;
-    if (!( Input >> IDName )) {
-      Input.putback('#');
-      return false;
-      return false;
-    }
+  template <class SinkType>
+  bool IDSelectorView::ParseFromBuffer(BasicBufferCursor<SinkType> &Input)
+  {
+    return ParsePrefixedIdentifier(Input, '#', Text);
+  }
 
-    Text = IDName.Text;
-    return true;
+  IDSelector IDSelectorView::Materialize() const
+  {
+    IDSelector Selector;
+    Selector.Text = std::string(Text);
+    return Selector;
   }
 
   /************************************************************************/
@@ -147,51 +381,33 @@ namespace css
   /************************************************************************/
   bool AttributeSelector::ParseFromInput(std::istream &Input)
   {
-    if (!Input)
-      REPORT_IO_SOURCE_INVALID_AND_RETURN(false);
-
-    if (Input.peek() != '[')
-      return false;
-
-    Input.ignore();
-
-    std::string TempAttr{ "" }, TempComp{ "" }, TempVal{ "" };
-    StringParser AttrString, ValString;
-
-    if (!( Input >> AttrString ))
-      return false;
-
-    char c = Input.peek();
-    while (c == '=' || IsOneOf(c, "|^$~*")) {
-      TempComp += Input.get();
-      c = Input.peek();
-    }
-
-    if (TempComp.empty() || TempComp.size() > 2) {
-      UndoExtraction(Input, TempComp);
-      UndoExtraction(Input, AttrString.Text);
-      return false;
-    }
+    StreamCursor Cursor(Input);
+    return ParseAttribute(Cursor, AttrText, CompText, ValText);
+  }
 
-    if (!( Input >> ValString )) {
-      UndoExtraction(Input, TempComp);
-      UndoExtraction(Input, AttrString.Text);
+  bool AttributeSelector::ParseFromBuffer(BufferCursor &Input)
+  {
+    AttributeSelectorView View;
+    if (!View.ParseFromBuffer(Input))
       return false;
-    }
 
-    if (Input.peek() != ']') {
-      UndoExtraction(Input, ValString.Text);
-      UndoExtraction(Input, TempComp);
-      UndoExtraction(Input, AttrString.Text);
-      return false;
-    }
+    *this = View.Materialize();
+    return true;
+  }
 
-    Input.ignore();
+  template <class SinkType>
+  bool AttributeSelectorView::ParseFromBuffer(BasicBufferCursor<SinkType> &Input)
+  {
+    return ParseAttribute(Input, AttrText, CompText, ValText);
+  }
 
-    AttrText = AttrString.Text;
-    CompText = TempComp;
-    ValText = ValString.Text;
-    return true;
+  AttributeSelector AttributeSelectorView::Materialize() const
+  {
+    AttributeSelector Selector;
+    Selector.AttrText = std::string(AttrText);
+    Selector.CompText = std::string(CompText);
+    Selector.ValText = std::string(ValText);
+    return Selector;
   }
 
   /************************************************************************/
@@ -199,70 +415,84 @@ namespace css
   /************************************************************************/
   bool Declaration::ParseFromInput(std::istream &Input)
   {
-    if (!Input)
-      return false;
-
-    TypeSelector Prop;
-
-    if (!( Input >> Prop )) {
-      return false;
-    }
+    StreamCursor Cursor(Input);
+    return ParseDeclaration(Cursor, PropertyText, ValueText, Id);
+  }
 
-    if (( char )Input.peek() != ':') {
+  bool Declaration::ParseFromBuffer(BufferCursor &Input)
+  {
+    DeclarationView View;
+    if (!View.ParseFromBuffer(Input))
       return false;
-    }
-
-    Input.ignore();
-    IgnoreWhitespace(Input);
 
-    std::string val{ "" };
+    *this = View.Materialize();
+    return true;
+  }
 
-    std::getline(Input, val, ';');
+  template <class SinkType>
+  bool DeclarationView::ParseFromBuffer(BasicBufferCursor<SinkType> &Input)
+  {
+    return ParseDeclaration(Input, PropertyText, ValueText, Id);
+  }
 
-    PropertyText = Prop.Text;
-    ValueText = val;
-    return true;
+  Declaration DeclarationView::Materialize() const
+  {
+    Declaration Decl;
+    Decl.PropertyText = std::string(PropertyText);
+    Decl.ValueText = std::string(ValueText);
+    Decl.Id = Id;
+    return Decl;
   }
 
   /************************************************************************/
   /* Declaration block                                                    */
   /************************************************************************/
-  bool DeclarationBlock::ParseFromInput(std::istream &Input)  
+  bool DeclarationBlock::ParseFromInput(std::istream &Input)
   {
-  if (!Input)
-    return false;
-
-  IgnoreWhitespace(Input);
-
-  if (Input.peek() != '{')
-    return false;
-
-  Input.ignore();
-
-  while (true) {
-    IgnoreWhitespace(Input);
-
-    if (Input.peek() == '}')
-      break;
-
-    Declaration decl;
-    if (!( Input >> decl ))
-      break;
-
-    Rules.push_back(decl);
+    StreamCursor Cursor(Input);
+    return ParseDeclarationBlock(Cursor, Rules);
   }
 
-  //Ignore anything remaining until we either run out of input (return false) or reach the closing brace
-  while (Input && Input.peek() != '}')
-    Input.ignore();
+  bool DeclarationBlock::ParseFromBuffer(BufferCursor &Input)
+  {
+    DeclarationBlockView View;
+    const bool Parsed = View.ParseFromBuffer(Input);
 
-  if (!Input)
-    return false;
+    /* An unterminated block still hands back the declarations it read */
+    if (Parsed || !View.Rules.empty())
+      *this = View.Materialize();
+    return Parsed;
+  }
 
-  if (Input.peek() == '}')
-    Input.ignore();
+  template <class SinkType>
+  bool DeclarationBlockView::ParseFromBuffer(BasicBufferCursor<SinkType> &Input)
+  {
+    return ParseDeclarationBlock(Input, Rules);
+  }
 
-  return true;
+  DeclarationBlock DeclarationBlockView::Materialize() const
+  {
+    DeclarationBlock Block;
+    Block.Rules.reserve(Rules.size());
+    for (const auto &Rule : Rules)
+      Block.Rules.push_back(Rule.Materialize());
+    return Block;
   }
 
+  /************************************************************************/
+  /* The views parse from both kinds of buffer cursor                     */
+  /************************************************************************/
+  template bool TypeSelectorView::ParseFromBuffer(BasicBufferCursor<DiagnosticSink> &);
+  template bool ClassSelectorView::ParseFromBuffer(BasicBufferCursor<DiagnosticSink> &);
+  template bool IDSelectorView::ParseFromBuffer(BasicBufferCursor<DiagnosticSink> &);
+  template bool AttributeSelectorView::ParseFromBuffer(BasicBufferCursor<DiagnosticSink> &);
+  template bool DeclarationView::ParseFromBuffer(BasicBufferCursor<DiagnosticSink> &);
+  template bool DeclarationBlockView::ParseFromBuffer(BasicBufferCursor<DiagnosticSink> &);
+  template bool TypeSelectorView::ParseFromBuffer(BasicBufferCursor<NullDiagnosticSink> &);
+  template bool ClassSelectorView::ParseFromBuffer(BasicBufferCursor<NullDiagnosticSink> &);
+  template bool IDSelectorView::ParseFromBuffer(BasicBufferCursor<NullDiagnosticSink> &);
+  template bool AttributeSelectorView::ParseFromBuffer(BasicBufferCursor<NullDiagnosticSink> &);
+  template bool DeclarationView::ParseFromBuffer(BasicBufferCursor<NullDiagnosticSink> &);
+  template bool DeclarationBlockView::ParseFromBuffer(BasicBufferCursor<NullDiagnosticSink> &);
+
 }
@@ -33,6 +33,8 @@
 ////////////////////////////////////////////////////////////
 // Internal Headers
 ////////////////////////////////////////////////////////////
+#include <Cursor.h>
+#include <Properties.h>
 
 ////////////////////////////////////////////////////////////
 // Dependency Headers
@@ -43,7 +45,9 @@
 ////////////////////////////////////////////////////////////
 #include <iostream>
 #include <istream>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
 
@@ -86,15 +90,10 @@
 namespace css
 {
 
-#define REPORT_PARSE_FAILURE_AND_RETURN(ERR_MSG, RET_VAL) \
+/* Hands CODE to whatever DiagnosticSink is attached to the INPUT cursor (see Diagnostics.h) */
+#define REPORT_DIAGNOSTIC_AND_RETURN(INPUT, CODE, RET_VAL) \
 { \
-std::cout << "Parse failure: " << ERR_MSG << "\n"; \
-return RET_VAL; \
-}
-
-#define REPORT_IO_SOURCE_INVALID_AND_RETURN(RET_VAL) \
-{ \
-std::cout << "Parse failure: Input stream is in an invalid state\n"; \
+INPUT.Report(DiagnosticCode::CODE); \
 return RET_VAL; \
 }
 
@@ -111,16 +110,6 @@ return RET_VAL; \
 
   __forceinline bool IsOneOf(char c, const std::string &str) { return str.find(c) != std::string::npos; }
 
-  __forceinline void UndoExtraction(std::istream &Input, const std::string &ToPutBack)
-  {
-    auto rbeg = ToPutBack.crbegin();
-    auto rend = ToPutBack.crend();
-
-    for (rbeg; rbeg != rend; ++rbeg) {
-      Input.putback(*rbeg);
-    }
-  }
-
   class GenericSelector
   {
   public:
@@ -128,6 +117,7 @@ return RET_VAL; \
     virtual operator bool() const { return false; }
 
     virtual bool ParseFromInput(std::istream &Input) = 0;
+    virtual bool ParseFromBuffer(BufferCursor &Input) = 0;
   };
 
   inline bool operator >> (std::istream &Input, GenericSelector &Selector)
@@ -135,6 +125,14 @@ return RET_VAL; \
     return Selector.ParseFromInput(Input);
   }
 
+  /* Works for both the owning selectors and the *View types below.  The views also take a
+     QuietBufferCursor (Cursor.h) */
+  template <class SinkType, class SelectorType>
+  inline bool operator >> (BasicBufferCursor<SinkType> &Input, SelectorType &Selector)
+  {
+    return Selector.ParseFromBuffer(Input);
+  }
+
   class StringParser
   {
   public:
@@ -154,6 +152,7 @@ return RET_VAL; \
     operator bool() const override { return !Text.empty(); }
 
     bool ParseFromInput(std::istream &Input) override final;
+    bool ParseFromBuffer(BufferCursor &Input) override final;
 
   };
 
@@ -166,6 +165,7 @@ return RET_VAL; \
     operator bool() const override { return !Text.empty(); }
 
     bool ParseFromInput(std::istream &Input) override final;
+    bool ParseFromBuffer(BufferCursor &Input) override final;
 
   };
 
@@ -178,6 +178,7 @@ return RET_VAL; \
     operator bool() const override { return !Text.empty(); }
 
     bool ParseFromInput(std::istream &Input) override final;
+    bool ParseFromBuffer(BufferCursor &Input) override final;
 
   };
 
@@ -192,6 +193,7 @@ return RET_VAL; \
     operator bool() const override { return !AttrText.empty() && !ValText.empty() && !CompText.empty(); }
 
     bool ParseFromInput(std::istream &Input) override final;
+    bool ParseFromBuffer(BufferCursor &Input) override final;
 
   };
 
@@ -201,14 +203,18 @@ return RET_VAL; \
 
     std::string PropertyText = "";
     std::string ValueText = "";
+    PropertyId  Id = PropertyId::Unknown;
 
     Declaration() = default;
     Declaration(const Declaration &) = default;
     Declaration(Declaration &&) = default;
+    Declaration &operator=(const Declaration &) = default;
+    Declaration &operator=(Declaration &&) = default;
 
     operator bool() const override { return !PropertyText.empty() && !ValueText.empty(); }
 
     bool ParseFromInput(std::istream &Input) override final;
+    bool ParseFromBuffer(BufferCursor &Input) override final;
 
   };
 
@@ -221,6 +227,104 @@ return RET_VAL; \
     operator bool() const override { return !Rules.empty(); }
 
     bool ParseFromInput(std::istream &Input) override final;
+    bool ParseFromBuffer(BufferCursor &Input) override final;
+
+  };
+
+  /************************************************************************/
+  /* Views                                                                */
+  /*   Same parsers as above, but the text is left where it was found.    */
+  /*   Every string_view points into the buffer the cursor walks, so the  */
+  /*   buffer must stay alive until the view is materialized or dropped.  */
+  /************************************************************************/
+  class TypeSelectorView
+  {
+  public:
+
+    std::string_view Text;
+
+    operator bool() const { return !Text.empty(); }
+
+    template <class SinkType>
+    bool ParseFromBuffer(BasicBufferCursor<SinkType> &Input);
+    TypeSelector Materialize() const;
+
+  };
+
+  class ClassSelectorView
+  {
+  public:
+
+    std::string_view Text;
+
+    operator bool() const { return !Text.empty(); }
+
+    template <class SinkType>
+    bool ParseFromBuffer(BasicBufferCursor<SinkType> &Input);
+    ClassSelector Materialize() const;
+
+  };
+
+  class IDSelectorView
+  {
+  public:
+
+    std::string_view Text;
+
+    operator bool() const { return !Text.empty(); }
+
+    template <class SinkType>
+    bool ParseFromBuffer(BasicBufferCursor<SinkType> &Input);
+    IDSelector Materialize() const;
+
+  };
+
+  class AttributeSelectorView
+  {
+  public:
+
+    std::string_view AttrText;
+    std::string_view ValText;
+    std::string_view CompText;
+
+    operator bool() const { return !AttrText.empty() && !ValText.empty() && !CompText.empty(); }
+
+    template <class SinkType>
+    bool ParseFromBuffer(BasicBufferCursor<SinkType> &Input);
+    AttributeSelector Materialize() const;
+
+  };
+
+  class DeclarationView
+  {
+  public:
+
+    std::string_view PropertyText;
+    std::string_view ValueText;
+    PropertyId       Id = PropertyId::Unknown;
+
+    operator bool() const { return !PropertyText.empty() && !ValueText.empty(); }
+
+    template <class SinkType>
+    bool ParseFromBuffer(BasicBufferCursor<SinkType> &Input);
+    Declaration Materialize() const;
+
+  };
+
+  class DeclarationBlockView
+  {
+  public:
+
+    std::pmr::vector<DeclarationView> Rules;
+
+    DeclarationBlockView() = default;
+    explicit DeclarationBlockView(std::pmr::memory_resource *Resource) : Rules(Resource) { }
+
+    operator bool() const { return !Rules.empty(); }
+
+    template <class SinkType>
+    bool ParseFromBuffer(BasicBufferCursor<SinkType> &Input);
+    DeclarationBlock Materialize() const;
 
   };
 
@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Styleable.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+
+namespace css
+{
+
+  /************************************************************************/
+  /* CachedElement                                                        */
+  /************************************************************************/
+
+  void StyleResolver::CachedElement::Reset(const Styleable &NewObject, StyleResolver &NewOwner)
+  {
+    Object = &NewObject;
+    Owner = &NewOwner;
+    TypeText = NewObject.Type();
+    IdText = NewObject.Id();
+    Classes.clear();
+    NewObject.Class(Classes);
+    Attributes.clear();
+    ParentCached = PreviousCached = false;
+  }
+
+  bool StyleResolver::CachedElement::Attribute(std::string_view Name, std::string_view &Value) const
+  {
+    for (const CachedAttribute &Each : Attributes) {
+      if (Each.Name == Name) {
+        Value = Each.Value;
+        return Each.Found;
+      }
+    }
+
+    CachedAttribute Asked{ Name, { }, false };
+    Asked.Found = Object->Attribute(Name, Asked.Value);
+    Attributes.push_back(Asked);
+
+    Value = Asked.Value;
+    return Asked.Found;
+  }
+
+  const Element* StyleResolver::CachedElement::Parent() const
+  {
+    if (!ParentCached) {
+      ParentElement = Owner->Wrap(Object->StyleParent());
+      ParentCached = true;
+    }
+    return ParentElement;
+  }
+
+  const Element* StyleResolver::CachedElement::PreviousSibling() const
+  {
+    if (!PreviousCached) {
+      PreviousElement = Owner->Wrap(Object->StylePreviousSibling());
+      PreviousCached = true;
+    }
+    return PreviousElement;
+  }
+
+  /************************************************************************/
+  /* StyleResolver                                                        */
+  /************************************************************************/
+
+  StyleResolver::StyleResolver(const Stylesheet &Sheet)
+    : Sheet(Sheet), Index(Sheet), Matcher(Sheet),
+      SelectorCount(Sheet.Selectors.size()), DeclarationCount(Sheet.Declarations.size()),
+      Winner(Sheet.Atoms.Size(), 0), Stamp(Sheet.Atoms.Size(), 0)
+  {
+  }
+
+  bool StyleResolver::IsCurrent(const Stylesheet &Other) const
+  {
+    return &Other == &Sheet && Other.Selectors.size() == SelectorCount && Other.Declarations.size() == DeclarationCount;
+  }
+
+  void StyleResolver::BeginResolution()
+  {
+    CacheUsed = 0;
+  }
+
+  const StyleResolver::CachedElement* StyleResolver::Wrap(const Styleable *Object)
+  {
+    if (!Object)
+      return nullptr;
+
+    /* Only the elements the matcher actually walked to are here, usually a handful */
+    for (std::size_t i = 0; i < CacheUsed; ++i)
+      if (Cache[i]->Object == Object)
+        return Cache[i].get();
+
+    if (CacheUsed == Cache.size())
+      Cache.push_back(std::make_unique<CachedElement>());
+
+    CachedElement &Cached = *Cache[CacheUsed++];
+    Cached.Reset(*Object, *this);
+    return &Cached;
+  }
+
+  void StyleResolver::Match(const Styleable &Object, std::vector<std::uint32_t> &Out)
+  {
+    BeginResolution();
+    Matcher.CollectMatches(Index, *Wrap(&Object), Out, UseAncestors ? &Ancestors : nullptr);
+  }
+
+  void StyleResolver::BeginAncestors(const Styleable &Object)
+  {
+    AncestorChain.clear();
+    for (const Styleable *Parent = Object.StyleParent(); Parent; Parent = Parent->StyleParent())
+      AncestorChain.push_back(Parent);
+
+    /* Root first, as a walk down to Object would have pushed them */
+    Ancestors.Clear();
+    for (auto Ancestor = AncestorChain.rbegin(); Ancestor != AncestorChain.rend(); ++Ancestor) {
+      BeginResolution();
+      PushAncestor(**Ancestor);
+    }
+    UseAncestors = true;
+  }
+
+  void StyleResolver::PushAncestor(const Styleable &Object)
+  {
+    /* Just after Object was matched it is still wrapped, and its accessors aren't asked again */
+    Ancestors.Push(*Wrap(&Object));
+  }
+
+  void StyleResolver::Resolve(const Styleable &Object, std::vector<std::uint32_t> &Out, std::vector<ResolvedProperty> &Style)
+  {
+    Out.clear();
+    Match(Object, Out);
+
+    /* Selectors of the same rule give the same declarations, so the key is the rule list */
+    MatchedRules.clear();
+    for (std::uint32_t Selector : Out)
+      MatchedRules.push_back(Sheet.Selectors[Selector].Rule);
+
+    const std::uint64_t Hash = MatchedDeclarationsCache::HashOf(MatchedRules);
+    if (const std::vector<ResolvedProperty> *Cached = Cascaded.Find(MatchedRules, Hash)) {
+      Style.assign(Cached->begin(), Cached->end());
+      return;
+    }
+
+    if (++Generation == 0) {
+      std::fill(Stamp.begin(), Stamp.end(), 0);
+      Generation = 1;
+    }
+    Touched.clear();
+
+    /* Matches are in cascade order, so the last declaration of a property wins */
+    for (std::uint32_t Selector : Out) {
+      const RuleRecord &Rule = Sheet.Rules[Sheet.Selectors[Selector].Rule];
+      for (std::uint32_t d = Rule.FirstDeclaration; d < Rule.FirstDeclaration + Rule.DeclarationCount; ++d) {
+        const Atom Property = Sheet.Declarations[d].Property;
+        if (Stamp[Property] != Generation) {
+          Stamp[Property] = Generation;
+          Touched.push_back(Property);
+        }
+        Winner[Property] = d;
+      }
+    }
+
+    std::sort(Touched.begin(), Touched.end());
+
+    Style.clear();
+    for (Atom Property : Touched)
+      Style.push_back({ Property, Winner[Property] });
+
+    Cascaded.Insert(MatchedRules, Hash, Style);
+  }
+
+  void StyleResolver::Apply(Styleable &Object)
+  {
+    Resolve(Object, Matched, Resolved);
+
+    for (const ResolvedProperty &Property : Resolved)
+      ApplyResolved(Object, Property);
+  }
+
+  void StyleResolver::ApplyResolved(Styleable &Object, const ResolvedProperty &Property) const
+  {
+    const DeclarationRecord &Declaration = Sheet.Declarations[Property.Declaration];
+    Object.ApplyValue(Declaration.Id, Sheet.TextOf(Property.Property), Sheet.TextOf(Declaration.Value), Sheet.ValueOf(Property.Declaration));
+  }
+
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Stylesheet.h>
+#include <RuleIndex.h>
+#include <Matcher.h>
+#include <DeclarationCache.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  Styleable
+//   - Derive your own types from this to have a Stylesheet
+//     style them: sheet.Apply(myObj)
+//   - The accessors are asked at most once per object per
+//     Apply (Attribute once per name), and the views they
+//     hand out only have to stay valid until Apply returns
+//   - ApplyValue is called once for every property the
+//     cascade gives the object, with its winning value
+//     both as text and as parsed (Values.h).  Override it
+//     to read typed values; by default it hands the text
+//     to ApplyProperty
+//
+//  StyleResolver
+//   - Does the work behind Stylesheet::Apply: finds the
+//     matching rules through a RuleIndex, cascades their
+//     declarations and calls ApplyProperty
+//   - Everything it needs per call (the cached accessor
+//     results, the matched rules, the winning declaration
+//     of each property) lives in buffers it keeps between
+//     calls, so styling an object allocates nothing once
+//     those have grown
+//   - Cascaded styles are kept in a
+//     MatchedDeclarationsCache keyed by the matched rules,
+//     so an object matching the same rules as an earlier
+//     one skips the cascade
+//   - Not thread safe; use one per thread
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  class Styleable
+  {
+  public:
+    virtual ~Styleable() = default;
+
+    virtual std::string_view Type() const = 0;
+    virtual std::string_view Id() const { return { }; }
+
+    /* Appends this object's classes to Classes */
+    virtual void Class(std::vector<std::string_view> & /*Classes*/) const { }
+
+    /* False if the object doesn't have the attribute at all */
+    virtual bool Attribute(std::string_view /*Name*/, std::string_view & /*Value*/) const { return false; }
+
+    virtual const Styleable* StyleParent() const { return nullptr; }
+    virtual const Styleable* StylePreviousSibling() const { return nullptr; }
+
+    /* Only needed to restyle whole trees (RestyleEngine) */
+    virtual Styleable* StyleFirstChild() const { return nullptr; }
+    virtual Styleable* StyleNextSibling() const { return nullptr; }
+
+    virtual void ApplyProperty(std::string_view Property, std::string_view Value) = 0;
+
+    virtual void ApplyValue(PropertyId /*Id*/, std::string_view Property, std::string_view Text, const ValueView & /*Value*/)
+    {
+      ApplyProperty(Property, Text);
+    }
+
+    /* A property the object had is no longer given to it by any rule */
+    virtual void ResetProperty(std::string_view /*Property*/) { }
+  };
+
+  class StyleResolver
+  {
+  public:
+
+    explicit StyleResolver(const Stylesheet &Sheet);
+
+    StyleResolver(const StyleResolver &) = delete;
+    StyleResolver& operator=(const StyleResolver &) = delete;
+
+    void Apply(Styleable &Object);
+
+    /* The selectors matching Object, lowest cascade rank first */
+    void Match(const Styleable &Object, std::vector<std::uint32_t> &Matched);
+
+    /* Matches Object and cascades the matched rules into Style, sorted by property atom */
+    void Resolve(const Styleable &Object, std::vector<std::uint32_t> &Matched, std::vector<ResolvedProperty> &Style);
+
+    /* Until EndAncestors, Match skips the selectors an AncestorFilter rules out.  BeginAncestors
+       fills it with Object's ancestors; walking down from there, PushAncestor each object before
+       matching its children and PopAncestor after, so it always holds the matched object's */
+    void BeginAncestors(const Styleable &Object);
+    void PushAncestor(const Styleable &Object);
+    void PopAncestor() { Ancestors.Pop(); }
+    void EndAncestors() { UseAncestors = false; }
+
+    /* How many selectors the filter has ruled out without walking up the tree */
+    std::size_t FilterRejections() const { return Matcher.FilterRejections(); }
+
+    /* Hands one property of a resolved style to Object.ApplyValue */
+    void ApplyResolved(Styleable &Object, const ResolvedProperty &Property) const;
+
+    const Stylesheet& Source() const { return Sheet; }
+
+    const MatchedDeclarationsCache& DeclarationCache() const { return Cascaded; }
+
+    /* False once Sheet has been moved or grown since this resolver was built from it */
+    bool IsCurrent(const Stylesheet &Other) const;
+
+  private:
+
+    /* A Styleable seen through the Element interface, with its accessors asked once */
+    class CachedElement : public Element
+    {
+    public:
+      void Reset(const Styleable &NewObject, StyleResolver &NewOwner);
+
+      std::string_view Tag() const override { return TypeText; }
+      std::string_view Id() const override { return IdText; }
+      std::size_t ClassCount() const override { return Classes.size(); }
+      std::string_view ClassAt(std::size_t Index) const override { return Classes[Index]; }
+      bool Attribute(std::string_view Name, std::string_view &Value) const override;
+      const Element* Parent() const override;
+      const Element* PreviousSibling() const override;
+
+      const Styleable *Object = nullptr;
+
+    private:
+      StyleResolver                *Owner = nullptr;
+      std::string_view              TypeText, IdText;
+      std::vector<std::string_view> Classes;
+
+      /* Every attribute asked about, found or not; a selector names only a few */
+      struct CachedAttribute
+      {
+        std::string_view Name, Value;
+        bool             Found;
+      };
+      mutable std::vector<CachedAttribute> Attributes;
+
+      mutable const Element        *ParentElement = nullptr, *PreviousElement = nullptr;
+      mutable bool                  ParentCached = false, PreviousCached = false;
+    };
+
+    /* Each object gets one CachedElement per call, however many times the matcher reaches it */
+    const CachedElement* Wrap(const Styleable *Object);
+    void BeginResolution();
+
+    const Stylesheet                            &Sheet;
+    RuleIndex                                    Index;
+    SelectorMatcher                              Matcher;
+    std::size_t                                  SelectorCount = 0, DeclarationCount = 0;
+
+    std::vector<std::unique_ptr<CachedElement>>  Cache;
+    std::size_t                                  CacheUsed = 0;
+    std::vector<std::uint32_t>                   Matched;
+    std::vector<std::uint32_t>                   MatchedRules;
+    std::vector<ResolvedProperty>                Resolved;
+    MatchedDeclarationsCache                     Cascaded;
+    std::vector<std::uint32_t>                   Winner;
+    std::vector<std::uint32_t>                   Stamp;
+    std::vector<Atom>                            Touched;
+    std::uint32_t                                Generation = 0;
+
+    AncestorFilter                               Ancestors;
+    std::vector<const Styleable*>                AncestorChain;
+    bool                                         UseAncestors = false;
+  };
+
+}
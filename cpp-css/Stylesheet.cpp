@@ -0,0 +1,710 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Stylesheet.h>
+#include <MappedFile.h>
+#include <Styleable.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+namespace css
+{
+
+  namespace
+  {
+
+    /* Comments are allowed anywhere whitespace is between rules and in selector lists */
+    void SkipWhitespaceAndComments(BufferCursor &Input)
+    {
+      while (true) {
+        Input.SkipWhitespace();
+
+        std::string_view Rest = Input.Remaining();
+        if (Rest.size() < 2 || Rest[0] != '/' || Rest[1] != '*')
+          return;
+
+        std::size_t Close = Rest.find("*/", 2);
+        if (Close == std::string_view::npos) {
+          Input.Report(DiagnosticCode::UnterminatedComment);
+          Input.Advance(Rest.size());
+          return;
+        }
+
+        Input.Advance(Close + 2);
+      }
+    }
+
+    __forceinline bool IsDelim(const Token &Of, std::string_view Source, char c)
+    {
+      return Of.Kind == TokenKind::Delim && Source[Of.Offset] == c;
+    }
+
+    __forceinline bool StartsCompound(const Token &Of, std::string_view Source)
+    {
+      return Of.Kind == TokenKind::Ident || Of.Kind == TokenKind::Hash || Of.Kind == TokenKind::LeftBracket ||
+             IsDelim(Of, Source, '*') || IsDelim(Of, Source, '.');
+    }
+
+    /* A rule's tokens always end with '}', ';' or EndOfFile, so this never runs off them */
+    __forceinline void SkipWhitespaceTokens(const Token *&Pos)
+    {
+      while (Pos->Kind == TokenKind::Whitespace)
+        ++Pos;
+    }
+
+  }
+
+  Stylesheet::Stylesheet(std::pmr::memory_resource *Resource)
+    : Rules(Resource), Selectors(Resource), Compounds(Resource), SimpleSelectors(Resource),
+      Declarations(Resource), Values(Resource), Text(Resource), Atoms(Resource)
+  {
+  }
+
+  /************************************************************************/
+  /* Parsing                                                              */
+  /************************************************************************/
+  bool Stylesheet::Parse(std::string_view Source, DiagnosticSink *Diagnostics)
+  {
+    BufferCursor Input(Source);
+    Input.SetDiagnostics(Diagnostics);
+    return ParseFromBuffer(Input);
+  }
+
+  bool Stylesheet::ParseFromInput(std::istream &Input, DiagnosticSink *Diagnostics)
+  {
+    /* Without a sink of its own, use whatever is attached to the stream */
+    if (!Diagnostics)
+      Diagnostics = StreamDiagnostics(Input);
+
+    StreamCursor Cursor(Input);
+    Cursor.SetDiagnostics(Diagnostics);
+
+    if (!Cursor.Good())
+      REPORT_DIAGNOSTIC_AND_RETURN(Cursor, InvalidSource, false);
+
+    std::string Source{ std::istreambuf_iterator<char>(Input), std::istreambuf_iterator<char>() };
+    return Parse(Source, Diagnostics);
+  }
+
+  bool Stylesheet::ParseFromFile(const std::string &Path, DiagnosticSink *Diagnostics)
+  {
+    MappedFile File(Path);
+    BufferCursor Input = File.Cursor();
+    Input.SetDiagnostics(Diagnostics);
+
+    if (!File)
+      REPORT_DIAGNOSTIC_AND_RETURN(Input, InvalidSource, false);
+
+    return ParseFromBuffer(Input);
+  }
+
+  bool Stylesheet::ParseFromBuffer(BufferCursor &Input)
+  {
+    if (!Input.Good())
+      REPORT_DIAGNOSTIC_AND_RETURN(Input, InvalidSource, false);
+
+    ParseRules(Input, Input.Mark() + Input.Remaining().size());
+    return true;
+  }
+
+  /* Parses whole rules until the cursor reaches StopAt (or the end of its buffer) */
+  void Stylesheet::ParseRules(BufferCursor &Input, BufferCursor::Position StopAt)
+  {
+    /* One token buffer is reused for every rule so parsing a rule doesn't allocate */
+    std::pmr::vector<Token> Tokens(Resource());
+    Tokens.reserve(64);
+
+    while (Input.Mark() < StopAt) {
+      SkipWhitespaceAndComments(Input);
+
+      if (Input.AtEnd())
+        return;
+
+      /* An ill-formed rule is skipped whole; its tokens already end where it does */
+      if (!ParseRule(Input, Tokens))
+        Input.Advance(Tokens.back().Offset + Tokens.back().Length);
+    }
+  }
+
+  /************************************************************************/
+  /* Parallel parsing                                                     */
+  /************************************************************************/
+  namespace
+  {
+
+    /* Holds a piece's diagnostics until we know whether the piece is kept */
+    class CollectingSink : public DiagnosticSink
+    {
+    public:
+
+      std::vector<Diagnostic> Issues;
+
+      void Report(const Diagnostic &Issue) override { Issues.push_back(Issue); }
+    };
+
+    /* Below this a piece isn't worth a thread */
+    constexpr std::size_t MinimumChunkSize = 16 * 1024;
+
+    /* One linear pass that tracks brace depth, strings and comments, and picks the first
+       top-level '}' at or after each of the evenly spaced targets as a boundary */
+    std::vector<std::size_t> FindChunkBoundaries(std::string_view Source, std::size_t ChunkCount)
+    {
+      std::vector<std::size_t> Boundaries{ 0 };
+      const std::size_t ChunkSize = Source.size() / ChunkCount;
+      std::size_t NextTarget = ChunkSize;
+      int Depth = 0;
+
+      for (std::size_t i = 0; i < Source.size() && Boundaries.size() < ChunkCount; ++i) {
+        const char c = Source[i];
+
+        if (c == '"' || c == '\'') {
+          for (++i; i < Source.size() && Source[i] != c; ++i)
+            if (Source[i] == '\\')
+              ++i;
+        }
+        else if (c == '/' && i + 1 < Source.size() && Source[i + 1] == '*') {
+          std::size_t Close = Source.find("*/", i + 2);
+          i = ( Close == std::string_view::npos ) ? Source.size() : Close + 1;
+        }
+        else if (c == '{') {
+          ++Depth;
+        }
+        else if (c == '}' && Depth > 0 && --Depth == 0 && i + 1 >= NextTarget) {
+          Boundaries.push_back(i + 1);
+          NextTarget = i + 1 + ChunkSize;
+        }
+      }
+
+      Boundaries.push_back(Source.size());
+      return Boundaries;
+    }
+
+  }
+
+  bool Stylesheet::ParseParallel(std::string_view Source, unsigned ThreadCount, DiagnosticSink *Diagnostics)
+  {
+    if (ThreadCount == 0)
+      ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    /* A few more pieces than threads evens out pieces that happen to be slow */
+    const std::size_t ChunkCount = std::min<std::size_t>(ThreadCount * 4, Source.size() / MinimumChunkSize);
+    if (ThreadCount == 1 || ChunkCount < 2)
+      return Parse(Source, Diagnostics);
+
+    const std::vector<std::size_t> Boundaries = FindChunkBoundaries(Source, ChunkCount);
+    const std::size_t PieceCount = Boundaries.size() - 1;
+
+    struct Piece
+    {
+      Stylesheet Sheet;
+      CollectingSink Issues;
+      BufferCursor::Position Stop = nullptr;
+    };
+
+    /* Pieces are parsed on the heap - an arena resource isn't safe to share between threads */
+    std::vector<Piece> Pieces(PieceCount);
+    std::atomic<std::size_t> NextPiece{ 0 };
+
+    auto Worker = [&]()
+    {
+      for (std::size_t p = NextPiece++; p < PieceCount; p = NextPiece++) {
+        BufferCursor Input(Source);
+        Input.SetDiagnostics(Diagnostics ? &Pieces[p].Issues : nullptr);
+        Input.Advance(Boundaries[p]);
+        Pieces[p].Sheet.ParseRules(Input, Source.data() + Boundaries[p + 1]);
+        Pieces[p].Stop = Input.Mark();
+      }
+    };
+
+    std::vector<std::thread> Threads;
+    for (unsigned t = 1; t < std::min<std::size_t>(ThreadCount, PieceCount); ++t)
+      Threads.emplace_back(Worker);
+    Worker();
+    for (auto &Thread : Threads)
+      Thread.join();
+
+    /* A piece only counts if the serial parse would have started it exactly where it did.
+       If a rule ran past a boundary, reparse from where it really ended instead */
+    BufferCursor Input(Source);
+    Input.SetDiagnostics(Diagnostics);
+
+    for (std::size_t p = 0; p < PieceCount; ++p) {
+      if (Input.Offset() == Boundaries[p]) {
+        Append(Pieces[p].Sheet);
+        for (const auto &Issue : Pieces[p].Issues.Issues)
+          Diagnostics->Report(Issue);
+        Input.Advance(( std::size_t )( Pieces[p].Stop - Input.Mark() ));
+      }
+      else if (Input.Offset() < Boundaries[p + 1]) {
+        ParseRules(Input, Source.data() + Boundaries[p + 1]);
+      }
+    }
+
+    return true;
+  }
+
+  void Stylesheet::Append(const Stylesheet &Other)
+  {
+    std::vector<Atom> AtomMap(Other.Atoms.Size(), NullAtom);
+    for (Atom Handle = 1; Handle < ( Atom )AtomMap.size(); ++Handle)
+      AtomMap[Handle] = Atoms.Intern(Other.Atoms.TextOf(Handle));
+
+    const auto RuleBase     = ( std::uint32_t )Rules.size();
+    const auto SelectorBase = ( std::uint32_t )Selectors.size();
+    const auto CompoundBase = ( std::uint32_t )Compounds.size();
+    const auto SimpleBase   = ( std::uint32_t )SimpleSelectors.size();
+    const auto DeclBase     = ( std::uint32_t )Declarations.size();
+    const auto ValueBase    = ( std::uint32_t )Values.size();
+    const auto TextBase     = ( std::uint32_t )Text.size();
+
+    auto Rebase = [TextBase](TextRef Ref) { Ref.Offset += Ref.Length ? TextBase : 0; return Ref; };
+
+    Text.append(Other.Text.data(), Other.Text.size());
+
+    for (RuleRecord Rule : Other.Rules) {
+      Rule.FirstSelector += SelectorBase;
+      Rule.FirstDeclaration += DeclBase;
+      Rules.push_back(Rule);
+    }
+
+    for (SelectorRecord Selector : Other.Selectors) {
+      Selector.FirstCompound += CompoundBase;
+      Selector.Rule += RuleBase;
+      Selectors.push_back(Selector);
+    }
+
+    for (CompoundRecord Compound : Other.Compounds) {
+      Compound.FirstSimple += SimpleBase;
+      Compounds.push_back(Compound);
+    }
+
+    for (SimpleSelectorRecord Simple : Other.SimpleSelectors) {
+      Simple.Name = AtomMap[Simple.Name];
+      Simple.Comparison = Rebase(Simple.Comparison);
+      Simple.Value = Rebase(Simple.Value);
+      SimpleSelectors.push_back(Simple);
+    }
+
+    for (DeclarationRecord Decl : Other.Declarations) {
+      Decl.Property = AtomMap[Decl.Property];
+      Decl.Value = Rebase(Decl.Value);
+      Decl.Parsed += ValueBase;
+      Declarations.push_back(Decl);
+    }
+
+    for (ValueRecord Value : Other.Values) {
+      if (Value.Kind == ValueKind::Keyword || Value.Kind == ValueKind::Function)
+        Value.Data = AtomMap[Value.Data];
+      Value.Text = Rebase(Value.Text);
+      Values.push_back(Value);
+    }
+  }
+
+  bool Stylesheet::ParseRule(BufferCursor &Input, std::pmr::vector<Token> &Tokens)
+  {
+    const TableSizes Saved = Sizes();
+    const std::string_view Source = Input.Remaining();
+    TokenizeRule(Source, Tokens);
+
+    /* A comment left open runs to the end, so it is just before EndOfFile.  Report it
+       before whatever went wrong at the end */
+    bool CommentReported = false;
+    auto Report = [&](DiagnosticCode Code, const Token &At)
+    {
+      const Token &Before = Tokens.size() > 1 ? Tokens[Tokens.size() - 2] : Tokens.back();
+      if (At.Kind == TokenKind::EndOfFile && Before.Kind == TokenKind::Whitespace && ( Before.Flags & TokenUnterminated ) && !CommentReported) {
+        Input.Report(DiagnosticCode::UnterminatedComment, Input.Offset() + Before.Offset);
+        CommentReported = true;
+      }
+      Input.Report(Code, Input.Offset() + At.Offset);
+    };
+
+    RuleRecord Rule;
+    Rule.FirstSelector = ( std::uint32_t )Selectors.size();
+    const auto RuleIndex = ( std::uint32_t )Rules.size();
+    const Token *Pos = Tokens.data();
+
+    while (true) {
+      SkipWhitespaceTokens(Pos);
+
+      if (!ParseSelector(Pos, Source, RuleIndex)) {
+        Report(DiagnosticCode::InvalidSelector, *Pos);
+        Truncate(Saved);
+        return false;
+      }
+
+      SkipWhitespaceTokens(Pos);
+
+      if (Pos->Kind != TokenKind::Comma)
+        break;
+
+      ++Pos;
+    }
+
+    if (Pos->Kind != TokenKind::LeftBrace) {
+      Report(DiagnosticCode::InvalidSelector, *Pos);
+      Truncate(Saved);
+      return false;
+    }
+
+    ++Pos;
+
+    Rule.SelectorCount = ( std::uint32_t )Selectors.size() - Rule.FirstSelector;
+    Rule.FirstDeclaration = ( std::uint32_t )Declarations.size();
+
+    ValueParser Parser(Values, Atoms);
+    while (true) {
+      while (Pos->Kind == TokenKind::Whitespace || Pos->Kind == TokenKind::Semicolon)
+        ++Pos;
+
+      if (Pos->Kind == TokenKind::RightBrace || Pos->Kind == TokenKind::EndOfFile)
+        break;
+
+      /* The declarations so far are kept; the tokens end where the block does */
+      if (!ParseDeclaration(Pos, Source, Parser)) {
+        Report(DiagnosticCode::InvalidDeclaration, *Pos);
+        Pos = &Tokens.back();
+        break;
+      }
+    }
+
+    if (Pos->Kind != TokenKind::RightBrace) {
+      Report(DiagnosticCode::UnterminatedBlock, *Pos);
+      Truncate(Saved);
+      return false;
+    }
+
+    Input.Advance(Pos->Offset + 1);
+
+    Rule.DeclarationCount = ( std::uint32_t )Declarations.size() - Rule.FirstDeclaration;
+    Rules.push_back(Rule);
+    return true;
+  }
+
+  bool Stylesheet::ParseSelector(const Token *&Pos, std::string_view Source, std::uint32_t Rule)
+  {
+    SelectorRecord Selector;
+    Selector.FirstCompound = ( std::uint32_t )Compounds.size();
+    Selector.Rule = Rule;
+
+    if (!ParseCompound(Pos, Source, Combinator::None))
+      return false;
+
+    while (true) {
+      const Token *Next = Pos;
+      SkipWhitespaceTokens(Next);
+
+      Combinator Between = Combinator::Descendant;
+      if (IsDelim(*Next, Source, '>'))
+        Between = Combinator::Child;
+      else if (IsDelim(*Next, Source, '+'))
+        Between = Combinator::NextSibling;
+      else if (IsDelim(*Next, Source, '~'))
+        Between = Combinator::SubsequentSibling;
+
+      if (Between != Combinator::Descendant) {
+        ++Next;
+        SkipWhitespaceTokens(Next);
+        Pos = Next;
+
+        /* A combinator has to be followed by another compound */
+        if (!StartsCompound(*Pos, Source))
+          return false;
+      }
+      /* Whitespace followed by another compound is the descendant combinator */
+      else if (Next == Pos || !StartsCompound(*Next, Source)) {
+        break;
+      }
+      else {
+        Pos = Next;
+      }
+
+      if (!ParseCompound(Pos, Source, Between))
+        return false;
+    }
+
+    Selector.CompoundCount = ( std::uint32_t )Compounds.size() - Selector.FirstCompound;
+
+    std::uint32_t IDs = 0, Classes = 0, Types = 0;
+    for (std::uint32_t s = Compounds[Selector.FirstCompound].FirstSimple; s < ( std::uint32_t )SimpleSelectors.size(); ++s) {
+      switch (SimpleSelectors[s].Kind)
+      {
+        case SimpleSelectorKind::ID:        ++IDs; break;
+        case SimpleSelectorKind::Class:
+        case SimpleSelectorKind::Attribute: ++Classes; break;
+        case SimpleSelectorKind::Type:      ++Types; break;
+        default:                            break;
+      }
+    }
+    Selector.Specificity = PackSpecificity(IDs, Classes, Types);
+
+    Selectors.push_back(Selector);
+    return true;
+  }
+
+  bool Stylesheet::ParseCompound(const Token *&Pos, std::string_view Source, Combinator LeftCombinator)
+  {
+    CompoundRecord Compound;
+    Compound.FirstSimple = ( std::uint32_t )SimpleSelectors.size();
+    Compound.LeftCombinator = LeftCombinator;
+
+    SimpleSelectorRecord Simple;
+
+    if (IsDelim(*Pos, Source, '*')) {
+      ++Pos;
+      Simple.Kind = SimpleSelectorKind::Universal;
+      SimpleSelectors.push_back(Simple);
+    }
+    else if (Pos->Kind == TokenKind::Ident) {
+      Simple.Kind = SimpleSelectorKind::Type;
+      Simple.Name = Atoms.Intern(css::TextOf(Source, *Pos++));
+      SimpleSelectors.push_back(Simple);
+    }
+
+    while (true) {
+      Simple = SimpleSelectorRecord();
+
+      /* Neither the '.' nor the '#' may be followed by whitespace, so each is one token or two adjacent ones */
+      if (IsDelim(*Pos, Source, '.')) {
+        if (Pos[1].Kind != TokenKind::Ident)
+          return false;
+        Simple.Kind = SimpleSelectorKind::Class;
+        Simple.Name = Atoms.Intern(css::TextOf(Source, Pos[1]));
+        Pos += 2;
+      }
+      else if (Pos->Kind == TokenKind::Hash) {
+        if (!( Pos->Flags & TokenIdHash ))
+          return false;
+        Simple.Kind = SimpleSelectorKind::ID;
+        Simple.Name = Atoms.Intern(css::TextOf(Source, *Pos).substr(1));
+        ++Pos;
+      }
+      else if (Pos->Kind == TokenKind::LeftBracket) {
+        /* [name], or [name op value] with op one of = ~= |= ^= $= *= and value an identifier or a string */
+        const Token *At = Pos + 1;
+        SkipWhitespaceTokens(At);
+        if (At->Kind != TokenKind::Ident)
+          return false;
+
+        Simple.Kind = SimpleSelectorKind::Attribute;
+        Simple.Name = Atoms.Intern(css::TextOf(Source, *At++));
+        SkipWhitespaceTokens(At);
+
+        if (At->Kind != TokenKind::RightBracket) {
+          const Token *Operator = At;
+          if (IsDelim(*At, Source, '='))
+            At += 1;
+          else if (At->Kind == TokenKind::Delim && IsOneOf(Source[At->Offset], "~|^$*") && IsDelim(At[1], Source, '='))
+            At += 2;
+          else
+            return false;
+
+          Simple.Comparison = StoreText(Source.substr(Operator->Offset, At[-1].Offset + 1 - Operator->Offset));
+          SkipWhitespaceTokens(At);
+
+          if (At->Kind == TokenKind::Ident)
+            Simple.Value = StoreText(css::TextOf(Source, *At));
+          else if (At->Kind == TokenKind::String && !( At->Flags & TokenUnterminated ))
+            Simple.Value = StoreText(Source.substr(At->Offset + 1, At->Length - 2));
+          else
+            return false;
+
+          ++At;
+          SkipWhitespaceTokens(At);
+          if (At->Kind != TokenKind::RightBracket)
+            return false;
+        }
+
+        Pos = At + 1;
+      }
+      else {
+        break;
+      }
+
+      SimpleSelectors.push_back(Simple);
+    }
+
+    Compound.SimpleCount = ( std::uint32_t )SimpleSelectors.size() - Compound.FirstSimple;
+    if (Compound.SimpleCount == 0)
+      return false;
+
+    Compounds.push_back(Compound);
+    return true;
+  }
+
+  /* property: value, up to a ';' or the '}' closing the block.  Brackets, functions and strings
+     in the value are whole tokens or nest, so a ';' or '}' inside them doesn't end it */
+  bool Stylesheet::ParseDeclaration(const Token *&Pos, std::string_view Source, ValueParser &Parser)
+  {
+    const Token *At = Pos;
+    if (At->Kind != TokenKind::Ident)
+      return false;
+
+    const Token &Property = *At++;
+    SkipWhitespaceTokens(At);
+    if (At->Kind != TokenKind::Colon)
+      return false;
+
+    ++At;
+    SkipWhitespaceTokens(At);
+
+    const Token *First = At, *Last = At;
+    int Depth = 0;
+    for (bool Done = false; !Done && At->Kind != TokenKind::EndOfFile; ) {
+      switch (At->Kind)
+      {
+        case TokenKind::Function:
+        case TokenKind::LeftParen:
+        case TokenKind::LeftBracket:
+        case TokenKind::LeftBrace:
+          ++Depth;
+          break;
+
+        case TokenKind::RightParen:
+        case TokenKind::RightBracket:
+          Depth -= Depth > 0;
+          break;
+
+        case TokenKind::RightBrace:
+          Done = Depth == 0;
+          Depth -= Depth > 0;
+          break;
+
+        case TokenKind::Semicolon:
+          Done = Depth == 0;
+          break;
+
+        default:
+          break;
+      }
+
+      if (Done)
+        break;
+
+      if (At->Kind != TokenKind::Whitespace)
+        Last = At + 1;
+      ++At;
+    }
+
+    const std::string_view Name = css::TextOf(Source, Property);
+    const std::uint32_t ValueStart = First->Offset;
+    const std::uint32_t ValueStop = Last != First ? Last[-1].Offset + Last[-1].Length : ValueStart;
+
+    DeclarationRecord Record;
+    Record.Property = Atoms.Intern(Name);
+    Record.Id = LookupProperty(Name);
+    Record.Value = StoreText(Source.substr(ValueStart, ValueStop - ValueStart));
+    Record.Parsed = Parser.Parse(First, Last, Source, Record.Value);
+    Declarations.push_back(Record);
+
+    Pos = At;
+    return true;
+  }
+
+  /************************************************************************/
+  /* Tables                                                               */
+  /************************************************************************/
+  void Stylesheet::CascadeOrder(std::vector<std::uint32_t> &Order) const
+  {
+    Order.resize(Selectors.size());
+    for (std::uint32_t s = 0; s < ( std::uint32_t )Order.size(); ++s)
+      Order[s] = s;
+
+    std::sort(Order.begin(), Order.end(), [this](std::uint32_t Left, std::uint32_t Right)
+    {
+      return CascadeKey(Left) < CascadeKey(Right);
+    });
+  }
+
+  void Stylesheet::Apply(Styleable &Object)
+  {
+    if (!Resolver || !Resolver->IsCurrent(*this))
+      Resolver = std::make_shared<StyleResolver>(*this);
+
+    Resolver->Apply(Object);
+  }
+
+  void Stylesheet::Clear()
+  {
+    Rules.clear();
+    Selectors.clear();
+    Compounds.clear();
+    SimpleSelectors.clear();
+    Declarations.clear();
+    Values.clear();
+    Text.clear();
+    Atoms.Clear();
+    Resolver.reset();
+  }
+
+  /* Empty text is always {0, 0}, so equal sheets have equal refs however they were built */
+  TextRef Stylesheet::StoreText(std::string_view Source)
+  {
+    TextRef Ref;
+    if (Source.empty())
+      return Ref;
+
+    Ref.Offset = ( std::uint32_t )Text.size();
+    Ref.Length = ( std::uint32_t )Source.size();
+    Text.append(Source.data(), Source.size());
+    return Ref;
+  }
+
+  Stylesheet::TableSizes Stylesheet::Sizes() const
+  {
+    return { Rules.size(), Selectors.size(), Compounds.size(), SimpleSelectors.size(), Declarations.size(), Values.size(), Text.size(), Atoms.Size() };
+  }
+
+  void Stylesheet::Truncate(const TableSizes &Saved)
+  {
+    Rules.resize(Saved.Rules);
+    Selectors.resize(Saved.Selectors);
+    Compounds.resize(Saved.Compounds);
+    SimpleSelectors.resize(Saved.SimpleSelectors);
+    Declarations.resize(Saved.Declarations);
+    Values.resize(Saved.Values);
+    Text.resize(Saved.Text);
+    Atoms.Truncate(Saved.Atoms);
+  }
+
+}
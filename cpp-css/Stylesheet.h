@@ -0,0 +1,258 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Selectors.h>
+#include <Atoms.h>
+#include <Values.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  Stylesheet
+//   - Parses a whole sheet (selector lists followed by
+//     declaration blocks) into one flat rule table
+//   - Nothing is a vector of vectors.  Every rule,
+//     selector, compound, simple selector and declaration
+//     lives in its own contiguous array and refers to its
+//     children by [First, First + Count) ranges
+//   - Names (types, classes, ids, attribute and property
+//     names) are interned into the sheet's AtomTable, so
+//     each distinct name is stored once and compared as an
+//     integer.  Other text (values) is copied once into
+//     Text and referred to by offset/length.  The sheet
+//     owns everything and does not depend on the buffer it
+//     was parsed from
+//   - Rules are stored in source order; a rule's index is
+//     its source order
+//   - Each selector's specificity is worked out once, while
+//     parsing, and packed into one integer.  CascadeOrder()
+//     lists the selectors the way the cascade ranks them,
+//     so anything built from it (RuleIndex buckets) is
+//     already sorted and matches only need merging
+//
+//     css::Stylesheet sheet;
+//     sheet.ParseFromFile("theme.css");
+//     for (const auto &Rule : sheet.Rules)
+//       for (auto d = Rule.FirstDeclaration; d < Rule.FirstDeclaration + Rule.DeclarationCount; ++d)
+//         use(sheet.TextOf(sheet.Declarations[d].Property), sheet.TextOf(sheet.Declarations[d].Value));
+//
+//   - Every table allocates from the memory resource the
+//     sheet was constructed with.  Pass a ParseArena's
+//     resource (Arena.h) to keep a whole parse in one
+//     arena; the sheet must then not outlive the arena
+//   - Each rule is tokenized (Tokenizer.h) and its
+//     selectors, declarations and values are parsed from
+//     those tokens, so no part of the grammar skips
+//     whitespace, comments or strings itself
+//   - Ill-formed rules are skipped (up to the end of their
+//     block) and parsing carries on with the next one
+//   - ParseParallel splits a large sheet at top-level '}'
+//     and parses the pieces on a pool of threads.  A piece
+//     is only kept if it starts exactly where the serial
+//     parse of everything before it ended, so the result
+//     is always identical to a serial parse
+//   - Declaration values are parsed once into Values
+//     (Values.h); ValueOf(d) reads one back
+//   - Apply(obj) styles a Styleable (Styleable.h).  The
+//     index it matches through is built on first use and
+//     rebuilt only when the sheet has changed since
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  class Styleable;
+  class StyleResolver;
+
+  enum class SimpleSelectorKind : std::uint8_t
+  {
+    Universal,
+    Type,
+    Class,
+    ID,
+    Attribute
+  };
+
+  /* How a compound relates to the compound to its left */
+  enum class Combinator : std::uint8_t
+  {
+    None,             // leftmost compound
+    Descendant,       // "a b"
+    Child,            // "a > b"
+    NextSibling,      // "a + b"
+    SubsequentSibling // "a ~ b"
+  };
+
+  struct SimpleSelectorRecord
+  {
+    SimpleSelectorKind Kind = SimpleSelectorKind::Universal;
+    Atom    Name = NullAtom;  // type, class, id or attribute name
+    TextRef Comparison;  // attribute selectors only
+    TextRef Value;       // attribute selectors only
+  };
+
+  /* A run of simple selectors with nothing between them, ie "button.sometype" */
+  struct CompoundRecord
+  {
+    std::uint32_t FirstSimple = 0;
+    std::uint32_t SimpleCount = 0;
+    Combinator    LeftCombinator = Combinator::None;
+  };
+
+  /* Ids in the top bits, then classes and attributes, then types, so two specificities
+     compare the way the cascade compares them.  Each count saturates at 1023 */
+  constexpr std::uint32_t PackSpecificity(std::uint32_t IDs, std::uint32_t Classes, std::uint32_t Types)
+  {
+    return ( ( IDs < 1023 ? IDs : 1023 ) << 20 ) | ( ( Classes < 1023 ? Classes : 1023 ) << 10 ) | ( Types < 1023 ? Types : 1023 );
+  }
+
+  /* One entry of a comma-separated selector list.  Compounds are stored left to right */
+  struct SelectorRecord
+  {
+    std::uint32_t FirstCompound = 0;
+    std::uint32_t CompoundCount = 0;
+    std::uint32_t Rule = 0;
+    std::uint32_t Specificity = 0;
+  };
+
+  struct DeclarationRecord
+  {
+    Atom          Property = NullAtom;
+    TextRef       Value;
+    PropertyId    Id = PropertyId::Unknown;
+    std::uint32_t Parsed = 0;  // root of the parsed value, in Values
+  };
+
+  struct RuleRecord
+  {
+    std::uint32_t FirstSelector = 0;
+    std::uint32_t SelectorCount = 0;
+    std::uint32_t FirstDeclaration = 0;
+    std::uint32_t DeclarationCount = 0;
+  };
+
+  class Stylesheet
+  {
+  public:
+
+    std::pmr::vector<RuleRecord>           Rules;
+    std::pmr::vector<SelectorRecord>       Selectors;
+    std::pmr::vector<CompoundRecord>       Compounds;
+    std::pmr::vector<SimpleSelectorRecord> SimpleSelectors;
+    std::pmr::vector<DeclarationRecord>    Declarations;
+    std::pmr::vector<ValueRecord>          Values;
+    std::pmr::string                       Text;
+    AtomTable                              Atoms;
+
+    explicit Stylesheet(std::pmr::memory_resource *Resource = std::pmr::get_default_resource());
+
+    std::pmr::memory_resource *Resource() const { return Rules.get_allocator().resource(); }
+
+    operator bool() const { return !Rules.empty(); }
+
+    /* Each of these appends to whatever the sheet already holds.  Problems with the input
+       are reported to Diagnostics (ParseFromBuffer uses the cursor's sink, and
+       ParseFromInput without one uses the stream's, see SetStreamDiagnostics) */
+    bool Parse(std::string_view Source, DiagnosticSink *Diagnostics = nullptr);
+    bool ParseFromBuffer(BufferCursor &Input);
+    bool ParseFromInput(std::istream &Input, DiagnosticSink *Diagnostics = nullptr);
+    bool ParseFromFile(const std::string &Path, DiagnosticSink *Diagnostics = nullptr);
+
+    /* Splits Source at top-level rule boundaries and parses the pieces on ThreadCount
+       threads (0 picks one per core).  The result, diagnostics included, is identical
+       to Parse(Source) */
+    bool ParseParallel(std::string_view Source, unsigned ThreadCount = 0, DiagnosticSink *Diagnostics = nullptr);
+
+    /* Appends Other's rules after this sheet's, as if they had been parsed here */
+    void Append(const Stylesheet &Other);
+
+    void Clear();
+
+    /* Calls Object.ApplyValue for every property the cascade gives it */
+    void Apply(Styleable &Object);
+
+    /* Orders selectors the way the cascade does: by specificity, then source order.
+       A selector's index is its source order */
+    std::uint64_t CascadeKey(std::uint32_t Selector) const
+    {
+      return ( ( std::uint64_t )Selectors[Selector].Specificity << 32 ) | Selector;
+    }
+
+    /* Every selector index, lowest cascade rank first */
+    void CascadeOrder(std::vector<std::uint32_t> &Order) const;
+
+    std::string_view TextOf(TextRef Ref) const { return std::string_view(Text.data() + Ref.Offset, Ref.Length); }
+    std::string_view TextOf(Atom Name) const { return Atoms.TextOf(Name); }
+
+    /* A declaration's value, as parsed */
+    ValueView ValueOf(std::uint32_t Declaration) const { return ValueView(*this, Declarations[Declaration].Parsed); }
+
+  private:
+
+    struct TableSizes
+    {
+      std::size_t Rules, Selectors, Compounds, SimpleSelectors, Declarations, Values, Text, Atoms;
+    };
+
+    TableSizes Sizes() const;
+    void Truncate(const TableSizes &Sizes);
+
+    TextRef StoreText(std::string_view Source);
+
+    void ParseRules(BufferCursor &Input, BufferCursor::Position StopAt);
+    bool ParseRule(BufferCursor &Input, std::pmr::vector<Token> &Tokens);
+    bool ParseSelector(const Token *&Pos, std::string_view Source, std::uint32_t Rule);
+    bool ParseCompound(const Token *&Pos, std::string_view Source, Combinator LeftCombinator);
+    bool ParseDeclaration(const Token *&Pos, std::string_view Source, ValueParser &Parser);
+
+    std::shared_ptr<StyleResolver> Resolver;
+  };
+
+}
@@ -32,6 +32,22 @@
 // Internal Headers
 ////////////////////////////////////////////////////////////
 #include <Selectors.h>
+#include <Arena.h>
+#include <MappedFile.h>
+#include <Scanner.h>
+#include <Stylesheet.h>
+#include <RuleIndex.h>
+#include <Matcher.h>
+#include <AncestorFilter.h>
+#include <Styleable.h>
+#include <Restyle.h>
+#include <InvalidationSet.h>
+#include <DeclarationCache.h>
+#include <Properties.h>
+#include <Values.h>
+#include <Colors.h>
+#include <Units.h>
+#include <Tokenizer.h>
 
 ////////////////////////////////////////////////////////////
 // Dependency Headers
@@ -40,6 +56,13 @@
 ////////////////////////////////////////////////////////////
 // Standard Library Headers
 ////////////////////////////////////////////////////////////
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
 
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
@@ -276,6 +299,10 @@ SCENARIO("Parsing attribute selectors", "[attribute-selector]")
       {
         REQUIRE_THAT(InputString.str(), cm::Equals("good-name[attr%(val]"));
       }
+      THEN("the input is rewound to the opening bracket")
+      {
+        REQUIRE(InputString.peek() == '[');
+      }
     }
   }
 }
@@ -404,6 +431,10 @@ SCENARIO("Parsing declarations in a block of style rules", "[style-declaration]"
       {
         REQUIRE_THAT(decl.ValueText, cm::Equals(""));
       }
+      THEN("the input is rewound to where the declaration started")
+      {
+        REQUIRE(InputString.peek() == 'p');
+      }
     }
   }
 
@@ -489,6 +520,88 @@ SCENARIO("Parsing an enclosed declaration block", "[enc-decl-block]")
   }
 }
 
+SCENARIO("A declaration block missing its closing brace", "[block-unterminated]")
+{
+  const std::string Source = "{ color: red; margin: 0";
+
+  GIVEN("a block that runs to the end of the input")
+  {
+    WHEN("it is parsed from a stream")
+    {
+      std::stringstream InputString(Source);
+      DeclarationBlock DBlock;
+      const bool Parsed = InputString >> DBlock;
+
+      THEN("parsing fails but the declarations read so far are kept")
+      {
+        REQUIRE_FALSE(Parsed);
+        REQUIRE(DBlock.Rules.size() == 2);
+        REQUIRE(DBlock.Rules[1].ValueText == "0");
+      }
+    }
+
+    WHEN("it is parsed from a buffer")
+    {
+      BufferCursor Input(Source);
+      DeclarationBlock DBlock;
+      const bool Parsed = Input >> DBlock;
+
+      THEN("the result is the same and the input is used up")
+      {
+        REQUIRE_FALSE(Parsed);
+        REQUIRE(DBlock.Rules.size() == 2);
+        REQUIRE(Input.AtEnd());
+      }
+    }
+  }
+}
+
+SCENARIO("A stream cursor only remembers what an open checkpoint can rewind to", "[stream-cursor]")
+{
+  GIVEN("a long stream of declarations read one at a time")
+  {
+    std::string Source;
+    for (int i = 0; i < 1000; ++i)
+      Source += "margin: " + std::to_string(i) + "px; ";
+    std::stringstream InputString(Source);
+    StreamCursor Input(InputString);
+
+    THEN("what is remembered stays the size of one declaration")
+    {
+      std::size_t MostRemembered = 0;
+      int Parsed = 0;
+      while (true) {
+        auto Saved = Input.Save();
+        Input.SkipUntil(';');
+        if (Input.Peek() != ';')
+          break;
+        Input.Ignore();
+        MostRemembered = std::max(MostRemembered, Input.Remembered());
+        ++Parsed;
+      }
+
+      REQUIRE(Parsed == 1000);
+      REQUIRE(Input.Offset() == Source.size());
+      REQUIRE(MostRemembered < 20);
+      REQUIRE(Input.Remembered() == 0);
+    }
+
+    THEN("nested checkpoints still rewind and slice across each other")
+    {
+      auto Outer = Input.Save();
+      const auto Start = Input.Mark();
+      {
+        auto Inner = Input.Save();
+        Input.SkipUntil(';');
+      }
+      REQUIRE(Input.Slice(Start) == "margin: 0px");
+      Input.Rewind(Outer);
+      REQUIRE(Input.Offset() == 0);
+      REQUIRE(Input.Get() == 'm');
+    }
+  }
+}
+
 SCENARIO("Parsing a complete style block with selector list", "[selectors-block]")
 {
   std::stringstream InputString("");
@@ -566,4 +679,2560 @@ SCENARIO("Parsing a complete style block with selector list", "[selectors-block]
     }
 
   }
-}
\ No newline at end of file
+}
+SCENARIO("Parsing directly from a contiguous buffer", "[buffer]")
+{
+  GIVEN("a buffer holding a selector list and declaration block")
+  {
+    const std::string Source = R"(test.with-class test#with-id test[withattr*=value]
+                                  { simple-prop: value42;
+                                    yet-another: rgba(0, 1, 1, 1);
+                                  })";
+
+    auto PointsIntoSource = [&Source](std::string_view View)
+    {
+      return View.data() >= Source.data() && View.data() + View.size() <= Source.data() + Source.size();
+    };
+
+    WHEN("the selectors and block are parsed into views")
+    {
+      BufferCursor Input(Source);
+
+      TypeSelectorView      TypeWithClass;
+      ClassSelectorView     TClass;
+      TypeSelectorView      TypeWithId;
+      IDSelectorView        TId;
+      TypeSelectorView      TypeWithAttr;
+      AttributeSelectorView TAttr;
+      DeclarationBlockView  DBlock;
+
+      REQUIRE(Input >> TypeWithClass);
+      REQUIRE(Input >> TClass);
+      REQUIRE(Input >> TypeWithId);
+      REQUIRE(Input >> TId);
+      REQUIRE(Input >> TypeWithAttr);
+      REQUIRE(Input >> TAttr);
+      REQUIRE(Input >> DBlock);
+
+      THEN("the views hold the same text the stream parsers produce")
+      {
+        REQUIRE(TypeWithClass.Text == "test");
+        REQUIRE(TClass.Text == "with-class");
+        REQUIRE(TId.Text == "with-id");
+        REQUIRE(TAttr.AttrText == "withattr");
+        REQUIRE(TAttr.CompText == "*=");
+        REQUIRE(TAttr.ValText == "value");
+        REQUIRE(DBlock.Rules.size() == 2);
+        REQUIRE(DBlock.Rules[0].PropertyText == "simple-prop");
+        REQUIRE(DBlock.Rules[0].ValueText == "value42");
+        REQUIRE(DBlock.Rules[1].PropertyText == "yet-another");
+        REQUIRE(DBlock.Rules[1].ValueText == "rgba(0, 1, 1, 1)");
+      }
+      AND_THEN("the views point into the source buffer instead of copying it")
+      {
+        REQUIRE(PointsIntoSource(TClass.Text));
+        REQUIRE(PointsIntoSource(TAttr.ValText));
+        REQUIRE(PointsIntoSource(DBlock.Rules[1].ValueText));
+      }
+      AND_THEN("the views can be materialized into owning selectors")
+      {
+        DeclarationBlock Owned = DBlock.Materialize();
+        REQUIRE(Owned.Rules.size() == 2);
+        REQUIRE_THAT(Owned.Rules[1].ValueText, cm::Equals("rgba(0, 1, 1, 1)"));
+        REQUIRE_THAT(TAttr.Materialize().CompText, cm::Equals("*="));
+      }
+      AND_THEN("the whole buffer was consumed")
+      {
+        Input.SkipWhitespace();
+        REQUIRE(Input.AtEnd());
+      }
+    }
+
+    WHEN("the owning selectors are parsed from the buffer")
+    {
+      BufferCursor Input(Source);
+      TypeSelector  TSel;
+      ClassSelector CSel;
+
+      bool typeParsed = Input >> TSel;
+      bool classParsed = Input >> CSel;
+
+      THEN("they store copies of the text")
+      {
+        REQUIRE(typeParsed);
+        REQUIRE(classParsed);
+        REQUIRE_THAT(TSel.Text, cm::Equals("test"));
+        REQUIRE_THAT(CSel.Text, cm::Equals("with-class"));
+      }
+    }
+  }
+
+  GIVEN("a buffer holding an ill-formed attribute selector")
+  {
+    const std::string Source = "[attr%(val]";
+    BufferCursor Input(Source);
+    AttributeSelectorView ASel;
+
+    WHEN("the attribute selector is parsed")
+    {
+      bool attrParsed = Input >> ASel;
+
+      THEN("it cannot be parsed and stores nothing")
+      {
+        REQUIRE_FALSE(attrParsed);
+        REQUIRE(ASel.AttrText.empty());
+      }
+      THEN("nothing is consumed from the buffer")
+      {
+        REQUIRE(Input.Offset() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("Parsing a memory-mapped stylesheet", "[mapped-file]")
+{
+  const std::string Path = "cpp-css-mapped-test.css";
+  const std::string Contents = "some-name.sometype { color: blue; float: left; }";
+
+  GIVEN("a stylesheet on disk")
+  {
+    {
+      std::ofstream Out(Path, std::ios::binary);
+      Out << Contents;
+    }
+
+    WHEN("the file is mapped and parsed")
+    {
+      DeclarationBlock Owned;
+      TypeSelector OwnedType;
+
+      {
+        MappedFile File(Path);
+        REQUIRE(File);
+        REQUIRE(File.Size() == Contents.size());
+
+        BufferCursor Input = File.Cursor();
+        TypeSelectorView Type;
+        ClassSelectorView Class;
+        DeclarationBlockView Block;
+
+        REQUIRE(Input >> Type);
+        REQUIRE(Input >> Class);
+        REQUIRE(Input >> Block);
+
+        THEN("the views borrow from the mapping")
+        {
+          REQUIRE(Type.Text.data() == File.View().data());
+          REQUIRE(Class.Text == "sometype");
+          REQUIRE(Block.Rules.size() == 2);
+        }
+
+        OwnedType = Type.Materialize();
+        Owned = Block.Materialize();
+      }
+
+      THEN("materialized results outlive the mapping")
+      {
+        REQUIRE_THAT(OwnedType.Text, cm::Equals("some-name"));
+        REQUIRE(Owned.Rules.size() == 2);
+        REQUIRE_THAT(Owned.Rules[1].PropertyText, cm::Equals("float"));
+        REQUIRE_THAT(Owned.Rules[1].ValueText, cm::Equals("left"));
+      }
+    }
+
+    std::remove(Path.c_str());
+  }
+
+  GIVEN("a path that does not exist")
+  {
+    MappedFile File;
+
+    THEN("the file cannot be opened")
+    {
+      REQUIRE_FALSE(File.Open("this-file-does-not-exist.css"));
+      REQUIRE_FALSE(File);
+    }
+  }
+}
+
+SCENARIO("Failed parse attempts rewind their input", "[checkpoint]")
+{
+  GIVEN("a buffer that only some parsers accept")
+  {
+    const std::string Source = "  [attr~=val  .cls";
+    BufferCursor Input(Source);
+
+    WHEN("several parsers are tried in turn")
+    {
+      AttributeSelectorView ASel;
+      IDSelectorView        IDSel;
+      DeclarationView       Decl;
+
+      bool attrParsed = Input >> ASel;
+      bool idParsed   = Input >> IDSel;
+      bool declParsed = Input >> Decl;
+
+      THEN("each failed attempt leaves the cursor where it started")
+      {
+        REQUIRE_FALSE(attrParsed);
+        REQUIRE_FALSE(idParsed);
+        REQUIRE_FALSE(declParsed);
+        REQUIRE(Input.Offset() == 0);
+      }
+    }
+
+    WHEN("a checkpoint is saved and rewound by hand")
+    {
+      auto Saved = Input.Save();
+      Input.SkipUntil('.');
+      ClassSelectorView CSel;
+      bool classParsed = Input >> CSel;
+      Input.Rewind(Saved);
+
+      THEN("the cursor returns to the checkpoint")
+      {
+        REQUIRE(classParsed);
+        REQUIRE(CSel.Text == "cls");
+        REQUIRE(Input.Offset() == 0);
+      }
+    }
+  }
+
+  GIVEN("a stream that only some parsers accept")
+  {
+    std::stringstream InputString("  #not-a-class");
+
+    WHEN("a class selector is tried before an id selector")
+    {
+      ClassSelector CSel;
+      IDSelector    IDSel;
+
+      bool classParsed = InputString >> CSel;
+      bool idParsed    = InputString >> IDSel;
+
+      THEN("the failed class attempt gives back everything it read")
+      {
+        REQUIRE_FALSE(classParsed);
+        REQUIRE(idParsed);
+        REQUIRE_THAT(IDSel.Text, cm::Equals("not-a-class"));
+      }
+    }
+  }
+}
+
+SCENARIO("Scanning runs of bytes with every supported instruction set", "[scanner]")
+{
+  const ScannerLevel Detected = DetectScannerLevel();
+  const ScannerLevel Levels[] = { ScannerLevel::Scalar, ScannerLevel::SSE2, ScannerLevel::AVX2 };
+
+  GIVEN("runs long enough to cross several vector widths")
+  {
+    /* 1, 15, 16, 17, 31, 32, 33 and 70 byte runs, each followed by a terminator */
+    const std::size_t RunLengths[] = { 1, 15, 16, 17, 31, 32, 33, 70 };
+
+    for (auto Level : Levels) {
+      if (Level > Detected)
+        continue;
+
+      REQUIRE(SetScannerLevel(Level));
+
+      for (auto Length : RunLengths) {
+        std::string Spaces(Length, ' ');
+        for (std::size_t i = 0; i < Length; i += 3)
+          Spaces[i] = "\t\n\r\f\v"[i % 5];
+        std::string Ident(Length, 'a');
+        for (std::size_t i = 0; i < Length; ++i)
+          Ident[i] = "azAZ09-q"[i % 8];
+        std::string Value(Length, 'x');
+
+        const std::string WsInput = Spaces + "x  ";
+        const std::string IdInput = Ident + "_rest";
+        const std::string StInput = Value + ";{}";
+
+        REQUIRE(ScanWhitespace(WsInput.data(), WsInput.data() + WsInput.size()) == WsInput.data() + Length);
+        REQUIRE(ScanIdentifier(IdInput.data(), IdInput.data() + IdInput.size()) == IdInput.data() + Length);
+        REQUIRE(ScanStructural(StInput.data(), StInput.data() + StInput.size()) == StInput.data() + Length);
+        REQUIRE(ScanUntil(StInput.data(), StInput.data() + StInput.size(), '{') == StInput.data() + Length + 1);
+      }
+    }
+
+    REQUIRE(SetScannerLevel(Detected));
+  }
+
+  GIVEN("runs that reach the end of the buffer")
+  {
+    const std::string Input(40, '-');
+
+    THEN("the scanners stop at the end without reading past it")
+    {
+      REQUIRE(ScanIdentifier(Input.data(), Input.data() + Input.size()) == Input.data() + Input.size());
+      REQUIRE(ScanStructural(Input.data(), Input.data() + Input.size()) == Input.data() + Input.size());
+      REQUIRE(ScanWhitespace(Input.data(), Input.data()) == Input.data());
+    }
+  }
+
+  GIVEN("bytes outside ASCII")
+  {
+    const std::string Input = "ab\xC1\xE1\xA0 \x85";
+
+    THEN("they are neither identifier characters nor whitespace")
+    {
+      REQUIRE(ScanIdentifier(Input.data(), Input.data() + Input.size()) == Input.data() + 2);
+      REQUIRE(ScanWhitespace(Input.data() + 2, Input.data() + Input.size()) == Input.data() + 2);
+    }
+  }
+}
+
+SCENARIO("Parsing a whole stylesheet into a flat rule table", "[stylesheet]")
+{
+  GIVEN("a stylesheet with several rules")
+  {
+    const std::string Source = R"(
+      span { color: red; }
+
+      /* selector lists and descendant selectors */
+      h1, mydiv button.sometype .class-without-type {
+        font-size: 12;
+        border: medium solid black;
+      }
+
+      test[withattr*=value]#with-id { yet-another: rgba(0, 1, 1, 1); }
+    )";
+
+    WHEN("the stylesheet is parsed")
+    {
+      Stylesheet Sheet;
+      bool parsed = Sheet.Parse(Source);
+
+      THEN("every rule is stored in source order")
+      {
+        REQUIRE(parsed);
+        REQUIRE(Sheet.Rules.size() == 3);
+        REQUIRE(Sheet.Selectors.size() == 4);
+        REQUIRE(Sheet.Declarations.size() == 4);
+        REQUIRE(Sheet.Rules[1].SelectorCount == 2);
+        REQUIRE(Sheet.Rules[1].DeclarationCount == 2);
+      }
+      AND_THEN("declarations refer to their text")
+      {
+        const auto &Decl = Sheet.Declarations[Sheet.Rules[1].FirstDeclaration + 1];
+        REQUIRE(Sheet.TextOf(Decl.Property) == "border");
+        REQUIRE(Sheet.TextOf(Decl.Value) == "medium solid black");
+      }
+      AND_THEN("descendant selectors are split into compounds")
+      {
+        const auto &Selector = Sheet.Selectors[2];
+        REQUIRE(Selector.Rule == 1);
+        REQUIRE(Selector.CompoundCount == 3);
+
+        const auto &Middle = Sheet.Compounds[Selector.FirstCompound + 1];
+        REQUIRE(Middle.LeftCombinator == Combinator::Descendant);
+        REQUIRE(Middle.SimpleCount == 2);
+        REQUIRE(Sheet.SimpleSelectors[Middle.FirstSimple].Kind == SimpleSelectorKind::Type);
+        REQUIRE(Sheet.TextOf(Sheet.SimpleSelectors[Middle.FirstSimple].Name) == "button");
+        REQUIRE(Sheet.SimpleSelectors[Middle.FirstSimple + 1].Kind == SimpleSelectorKind::Class);
+        REQUIRE(Sheet.TextOf(Sheet.SimpleSelectors[Middle.FirstSimple + 1].Name) == "sometype");
+      }
+      AND_THEN("attribute and id selectors are stored with the compound")
+      {
+        const auto &Compound = Sheet.Compounds[Sheet.Selectors[3].FirstCompound];
+        REQUIRE(Compound.SimpleCount == 3);
+
+        const auto &Attr = Sheet.SimpleSelectors[Compound.FirstSimple + 1];
+        REQUIRE(Attr.Kind == SimpleSelectorKind::Attribute);
+        REQUIRE(Sheet.TextOf(Attr.Name) == "withattr");
+        REQUIRE(Sheet.TextOf(Attr.Comparison) == "*=");
+        REQUIRE(Sheet.TextOf(Attr.Value) == "value");
+        REQUIRE(Sheet.SimpleSelectors[Compound.FirstSimple + 2].Kind == SimpleSelectorKind::ID);
+      }
+    }
+  }
+
+  GIVEN("a stylesheet with an ill-formed rule between two good ones")
+  {
+    const std::string Source = "a { color: red; } %bad { x: y; } b { float: left; }";
+
+    WHEN("the stylesheet is parsed from a stream")
+    {
+      std::stringstream InputString(Source);
+      Stylesheet Sheet;
+      bool parsed = Sheet.ParseFromInput(InputString);
+
+      THEN("the ill-formed rule is skipped and the rest still parse")
+      {
+        REQUIRE(parsed);
+        REQUIRE(Sheet.Rules.size() == 2);
+        REQUIRE(Sheet.TextOf(Sheet.SimpleSelectors[1].Name) == "b");
+        REQUIRE(Sheet.TextOf(Sheet.Declarations[1].Property) == "float");
+      }
+    }
+  }
+}
+
+SCENARIO("Parsing into an arena", "[arena]")
+{
+  GIVEN("a stylesheet with a few hundred rules")
+  {
+    std::string Source;
+    for (int i = 0; i < 300; ++i)
+      Source += "div.item" + std::to_string(i) + " span { color: red; margin: " + std::to_string(i) + "px; }\n";
+
+    WHEN("the stylesheet is parsed straight from the heap")
+    {
+      AllocationCounter Heap;
+      Stylesheet Sheet(&Heap);
+      REQUIRE(Sheet.Parse(Source));
+
+      THEN("only the tables themselves allocate, not each rule")
+      {
+        REQUIRE(Sheet.Rules.size() == 300);
+        REQUIRE(Heap.Allocations() < 100);
+      }
+    }
+
+    WHEN("the stylesheet is parsed into an arena")
+    {
+      ParseArena Arena(256 * 1024);
+      std::size_t DeclarationCount = 0;
+
+      {
+        Stylesheet Sheet(Arena.Resource());
+        REQUIRE(Sheet.Parse(Source));
+        DeclarationCount = Sheet.Declarations.size();
+        REQUIRE(Sheet.TextOf(Sheet.Declarations[599].Value) == "299px");
+      }
+
+      THEN("the whole parse costs the arena a single block from the heap")
+      {
+        REQUIRE(DeclarationCount == 600);
+        REQUIRE(Arena.Upstream().Allocations() == 1);
+      }
+      AND_THEN("everything is freed in one release")
+      {
+        Arena.Release();
+        REQUIRE(Arena.Upstream().Deallocations() == Arena.Upstream().Allocations());
+      }
+    }
+
+    WHEN("a declaration block view is parsed into an arena")
+    {
+      ParseArena Arena;
+      DeclarationBlockView Block(Arena.Resource());
+      BufferCursor Input(std::string_view("{ a: b; c: d; e: f; }"));
+
+      THEN("its rules are allocated from the arena")
+      {
+        REQUIRE(Input >> Block);
+        REQUIRE(Block.Rules.size() == 3);
+        REQUIRE(Block.Rules.get_allocator().resource() == Arena.Resource());
+      }
+    }
+  }
+}
+
+SCENARIO("Interning names into atoms", "[atoms]")
+{
+  GIVEN("a stylesheet that repeats the same names")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(R"(.btn { color: red; }
+                   .btn span { color: blue; }
+                   span.btn { color: green; margin: 0; })");
+
+    THEN("each distinct name is stored once")
+    {
+      /* NullAtom, btn, color, span, margin */
+      REQUIRE(Sheet.Atoms.Size() == 5);
+    }
+    THEN("equal names get equal atoms")
+    {
+      REQUIRE(Sheet.Declarations[0].Property == Sheet.Declarations[1].Property);
+      REQUIRE(Sheet.Declarations[0].Property == Sheet.Declarations[2].Property);
+      REQUIRE(Sheet.Declarations[2].Property != Sheet.Declarations[3].Property);
+      REQUIRE(Sheet.SimpleSelectors[0].Name == Sheet.Atoms.Find("btn"));
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[3].Property) == "margin");
+    }
+    THEN("names that were never seen are not found")
+    {
+      REQUIRE(Sheet.Atoms.Find("div") == NullAtom);
+      REQUIRE(Sheet.Atoms.Find("") == NullAtom);
+    }
+  }
+
+  GIVEN("an atom table that has to grow")
+  {
+    AtomTable Atoms;
+    std::vector<Atom> Handles;
+    for (int i = 0; i < 1000; ++i)
+      Handles.push_back(Atoms.Intern("name-" + std::to_string(i)));
+
+    THEN("every name keeps its atom")
+    {
+      bool AllFound = true;
+      for (int i = 0; i < 1000; ++i) {
+        AllFound = AllFound && Atoms.Find("name-" + std::to_string(i)) == Handles[i];
+        AllFound = AllFound && Atoms.TextOf(Handles[i]) == "name-" + std::to_string(i);
+      }
+
+      REQUIRE(Atoms.Size() == 1001);
+      REQUIRE(AllFound);
+    }
+  }
+}
+
+/* Field by field, so padding never takes part */
+static bool SameTables(const Stylesheet &Left, const Stylesheet &Right)
+{
+  auto SameText = [](TextRef A, TextRef B) { return A.Offset == B.Offset && A.Length == B.Length; };
+
+  if (Left.Rules.size() != Right.Rules.size() || Left.Selectors.size() != Right.Selectors.size() ||
+      Left.Compounds.size() != Right.Compounds.size() || Left.SimpleSelectors.size() != Right.SimpleSelectors.size() ||
+      Left.Declarations.size() != Right.Declarations.size() || Left.Values.size() != Right.Values.size() || Left.Text != Right.Text ||
+      Left.Atoms.Size() != Right.Atoms.Size())
+    return false;
+
+  for (Atom a = 0; a < ( Atom )Left.Atoms.Size(); ++a)
+    if (Left.Atoms.TextOf(a) != Right.Atoms.TextOf(a))
+      return false;
+
+  for (std::size_t i = 0; i < Left.Rules.size(); ++i) {
+    const auto &A = Left.Rules[i], &B = Right.Rules[i];
+    if (A.FirstSelector != B.FirstSelector || A.SelectorCount != B.SelectorCount ||
+        A.FirstDeclaration != B.FirstDeclaration || A.DeclarationCount != B.DeclarationCount)
+      return false;
+  }
+  for (std::size_t i = 0; i < Left.Selectors.size(); ++i) {
+    const auto &A = Left.Selectors[i], &B = Right.Selectors[i];
+    if (A.FirstCompound != B.FirstCompound || A.CompoundCount != B.CompoundCount || A.Rule != B.Rule || A.Specificity != B.Specificity)
+      return false;
+  }
+  for (std::size_t i = 0; i < Left.Compounds.size(); ++i) {
+    const auto &A = Left.Compounds[i], &B = Right.Compounds[i];
+    if (A.FirstSimple != B.FirstSimple || A.SimpleCount != B.SimpleCount || A.LeftCombinator != B.LeftCombinator)
+      return false;
+  }
+  for (std::size_t i = 0; i < Left.SimpleSelectors.size(); ++i) {
+    const auto &A = Left.SimpleSelectors[i], &B = Right.SimpleSelectors[i];
+    if (A.Kind != B.Kind || A.Name != B.Name || !SameText(A.Comparison, B.Comparison) || !SameText(A.Value, B.Value))
+      return false;
+  }
+  for (std::size_t i = 0; i < Left.Declarations.size(); ++i) {
+    const auto &A = Left.Declarations[i], &B = Right.Declarations[i];
+    if (A.Property != B.Property || A.Id != B.Id || !SameText(A.Value, B.Value) || A.Parsed != B.Parsed)
+      return false;
+  }
+  for (std::size_t i = 0; i < Left.Values.size(); ++i) {
+    const auto &A = Left.Values[i], &B = Right.Values[i];
+    if (A.Kind != B.Kind || A.Flags != B.Flags || A.Count != B.Count || A.Size != B.Size ||
+        A.Number != B.Number || A.Data != B.Data || !SameText(A.Text, B.Text))
+      return false;
+  }
+
+  return true;
+}
+
+SCENARIO("Parsing a large stylesheet in parallel", "[parallel]")
+{
+  GIVEN("a large stylesheet with comments, strings and ill-formed rules")
+  {
+    std::string Source;
+    for (int i = 0; i < 4000; ++i) {
+      const std::string n = std::to_string(i);
+      Source += "div.item" + n + " span, #id" + n + " { color: red; margin: " + n + "px; }\n";
+      if (i % 97 == 0)
+        Source += "/* a comment with { braces } in it */\n";
+      if (i % 211 == 0)
+        Source += "%ill-formed" + n + " { x: y; }\n";
+      /* The serial parse ends this block at the '}' inside the string and then skips the rest of
+         the sheet looking for the closing quote, so every piece after it has to be reparsed */
+      if (i == 2000)
+        Source += "q" + n + " { content: \"x;}\"; quotes: none; }\n";
+    }
+
+    WHEN("it is parsed serially and in parallel")
+    {
+      Stylesheet Serial;
+      Stylesheet Parallel;
+
+      REQUIRE(Serial.Parse(Source));
+      REQUIRE(Parallel.ParseParallel(Source, 4));
+
+      THEN("both parses produce exactly the same tables")
+      {
+        REQUIRE(Serial.Rules.size() > 2000);
+        REQUIRE(SameTables(Serial, Parallel));
+      }
+    }
+  }
+
+  GIVEN("two stylesheets")
+  {
+    Stylesheet First, Second, Both;
+    First.Parse("a.x { color: red; }");
+    Second.Parse("b.x { color: blue; } c { margin: 0; }");
+    Both.Parse("a.x { color: red; } b.x { color: blue; } c { margin: 0; }");
+
+    WHEN("one is appended to the other")
+    {
+      First.Append(Second);
+
+      THEN("the result is the same as parsing them together")
+      {
+        REQUIRE(SameTables(First, Both));
+      }
+    }
+  }
+}
+
+SCENARIO("Choosing where the selector parsers report", "[diagnostics-sinks]")
+{
+  static_assert(!std::is_base_of<DiagnosticSink, NullDiagnosticSink>::value, "the null sink is never called through a vtable");
+
+  const std::string Source = "{ color: red; =oops; }";
+
+  GIVEN("a sink attached to a stream")
+  {
+    std::stringstream InputString(Source);
+    Diagnostic Issues[4];
+    BufferDiagnosticSink Sink(Issues);
+    SetStreamDiagnostics(InputString, &Sink);
+
+    WHEN("a block is read with operator>>")
+    {
+      DeclarationBlock DBlock;
+      REQUIRE(InputString >> DBlock);
+
+      THEN("the stream parsers report to it")
+      {
+        REQUIRE(DBlock.Rules.size() == 1);
+        REQUIRE(Sink.Count() == 1);
+        REQUIRE(Sink[0].Code == DiagnosticCode::InvalidDeclaration);
+        REQUIRE(Sink[0].Offset == Source.find("=oops"));
+      }
+    }
+
+    WHEN("the sink is detached again")
+    {
+      SetStreamDiagnostics(InputString, nullptr);
+      DeclarationBlock DBlock;
+      REQUIRE(InputString >> DBlock);
+
+      THEN("nothing is reported")
+      {
+        REQUIRE(Sink.Count() == 0);
+      }
+    }
+
+    WHEN("a whole sheet is read from the stream")
+    {
+      std::stringstream SheetString("a { =oops; }");
+      SetStreamDiagnostics(SheetString, &Sink);
+      Stylesheet Sheet;
+      Sheet.ParseFromInput(SheetString);
+
+      THEN("the sheet reports to the stream's sink too")
+      {
+        REQUIRE(Sink.Count() == 1);
+        REQUIRE(Sink[0].Code == DiagnosticCode::InvalidDeclaration);
+      }
+    }
+  }
+
+  GIVEN("a quiet buffer cursor")
+  {
+    QuietBufferCursor Input(Source);
+    DeclarationBlockView DBlock;
+
+    THEN("the views parse exactly as they do with a reporting cursor")
+    {
+      REQUIRE(Input >> DBlock);
+      REQUIRE(DBlock.Rules.size() == 1);
+      REQUIRE(DBlock.Rules[0].ValueText == "red");
+      REQUIRE(Input.AtEnd());
+    }
+  }
+}
+
+SCENARIO("Reporting problems with the input to a diagnostics sink", "[diagnostics]")
+{
+  GIVEN("a stylesheet with several problems")
+  {
+    const std::string Source = "a { color: red; }\n"
+                               "b:hover { color: blue; }\n"
+                               "c { float: left; =oops; }\n"
+                               "d { margin: 0; /* never closed";
+
+    WHEN("it is parsed with a buffer sink attached")
+    {
+      Diagnostic Issues[8];
+      BufferDiagnosticSink Sink(Issues);
+      Stylesheet Sheet;
+      Sheet.Parse(Source, &Sink);
+
+      THEN("each problem is recorded with its code and byte offset")
+      {
+        REQUIRE(Sink.Count() == 4);
+        REQUIRE(Sink[0].Code == DiagnosticCode::InvalidSelector);
+        REQUIRE(Sink[0].Offset == Source.find(":hover"));
+        REQUIRE(Sink[1].Code == DiagnosticCode::InvalidDeclaration);
+        REQUIRE(Sink[1].Offset == Source.find("=oops"));
+        REQUIRE(Sink[2].Code == DiagnosticCode::UnterminatedComment);
+        REQUIRE(Sink[2].Offset == Source.find("/*"));
+        REQUIRE(Sink[3].Code == DiagnosticCode::UnterminatedBlock);
+        REQUIRE(Sink[3].Offset == Source.size());
+      }
+      AND_THEN("the good rules still parse")
+      {
+        REQUIRE(Sheet.Rules.size() == 2);
+      }
+    }
+
+    WHEN("the sink is too small")
+    {
+      Diagnostic Issues[1];
+      BufferDiagnosticSink Sink(Issues);
+      Stylesheet Sheet;
+      Sheet.Parse(Source, &Sink);
+
+      THEN("the rest are counted but not stored")
+      {
+        REQUIRE(Sink.Count() == 1);
+        REQUIRE(Sink.Dropped() == 3);
+      }
+    }
+  }
+
+  GIVEN("a large stylesheet with problems scattered through it")
+  {
+    std::string Source;
+    for (int i = 0; i < 3000; ++i) {
+      Source += "p.x" + std::to_string(i) + " { color: red; }\n";
+      if (i % 300 == 0)
+        Source += "q:bad { a: b; }\n";
+    }
+
+    WHEN("it is parsed serially and in parallel")
+    {
+      std::vector<Diagnostic> SerialIssues(64), ParallelIssues(64);
+      BufferDiagnosticSink SerialSink(SerialIssues.data(), SerialIssues.size());
+      BufferDiagnosticSink ParallelSink(ParallelIssues.data(), ParallelIssues.size());
+
+      Stylesheet Serial, Parallel;
+      Serial.Parse(Source, &SerialSink);
+      Parallel.ParseParallel(Source, 4, &ParallelSink);
+
+      THEN("both report the same problems in the same order")
+      {
+        bool SameIssues = SerialSink.Count() == ParallelSink.Count();
+        for (std::size_t i = 0; SameIssues && i < SerialSink.Count(); ++i)
+          SameIssues = SerialSink[i].Code == ParallelSink[i].Code && SerialSink[i].Offset == ParallelSink[i].Offset;
+
+        REQUIRE(SerialSink.Count() == 10);
+        REQUIRE(SameIssues);
+      }
+    }
+  }
+}
+
+SCENARIO("Finding candidate rules through the rule index", "[rule-index]")
+{
+  GIVEN("a stylesheet with selectors keyed in every way")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "#main { a: 1; }\n"                 // 0: id
+      "div.box#main { a: 2; }\n"          // 1: id wins over class and type
+      "p .box.wide { a: 3; }\n"           // 2: first class of the rightmost compound
+      "span { a: 4; }\n"                  // 3: type
+      "* { a: 5; }\n"                     // 4: universal
+      "[href=x] { a: 6; }\n"              // 5: attribute only goes in universal
+      ".box span { a: 7; }\n"             // 6: only the rightmost compound counts
+      "a, .wide { a: 8; }\n"              // 7, 8: each selector filed separately
+    );
+
+    RuleIndex Index(Sheet);
+
+    WHEN("selectors are filed")
+    {
+      THEN("each goes into the bucket for the most selective key of its rightmost compound")
+      {
+        Atom Key = NullAtom;
+        REQUIRE(RuleIndex::KeyOf(Sheet, 1, Key) == BucketKind::ID);
+        REQUIRE(Key == Sheet.Atoms.Find("main"));
+        REQUIRE(RuleIndex::KeyOf(Sheet, 2, Key) == BucketKind::Class);
+        REQUIRE(Key == Sheet.Atoms.Find("box"));
+        REQUIRE(RuleIndex::KeyOf(Sheet, 5, Key) == BucketKind::Universal);
+        REQUIRE(RuleIndex::KeyOf(Sheet, 6, Key) == BucketKind::Type);
+        REQUIRE(Key == Sheet.Atoms.Find("span"));
+
+        REQUIRE(Index.IDBucket(Sheet.Atoms.Find("main")).size() == 2);
+        REQUIRE(Index.ClassBucket(Sheet.Atoms.Find("wide")).size() == 1);
+        REQUIRE(Index.UniversalBucket().size() == 2);
+        REQUIRE(Index.TypeBucket(NullAtom).empty());
+      }
+    }
+
+    WHEN("an element's candidates are collected")
+    {
+      Atom Classes[] = { Sheet.Atoms.Find("box"), Sheet.Atoms.Find("unknown") };
+
+      ElementKeys Keys;
+      Keys.Tag = Sheet.Atoms.Find("span");
+      Keys.Classes = Classes;
+      Keys.ClassCount = 2;
+
+      std::vector<std::uint32_t> Candidates;
+      Index.CollectCandidates(Keys, Candidates);
+
+      THEN("only the buckets for its keys are visited")
+      {
+        const std::vector<std::uint32_t> Expected = { 2, 3, 6, 4, 5 };
+        REQUIRE(Candidates == Expected);
+      }
+    }
+  }
+}
+
+/* A minimal element tree for the matcher tests */
+struct TestElement : public Element
+{
+  std::string                                      TagName, IdName;
+  std::vector<std::string>                         Classes;
+  std::vector<std::pair<std::string, std::string>> Attributes;
+  TestElement                                     *ParentElement = nullptr, *Previous = nullptr;
+
+  TestElement(std::string Tag, std::string Id = "", std::vector<std::string> Cls = { })
+    : TagName(std::move(Tag)), IdName(std::move(Id)), Classes(std::move(Cls)) { }
+
+  TestElement& AppendTo(TestElement &NewParent, TestElement *NewPrevious = nullptr)
+  {
+    ParentElement = &NewParent;
+    Previous = NewPrevious;
+    return *this;
+  }
+
+  std::string_view Tag() const override { return TagName; }
+  std::string_view Id() const override { return IdName; }
+  std::size_t ClassCount() const override { return Classes.size(); }
+  std::string_view ClassAt(std::size_t Index) const override { return Classes[Index]; }
+  const Element* Parent() const override { return ParentElement; }
+  const Element* PreviousSibling() const override { return Previous; }
+
+  bool Attribute(std::string_view Name, std::string_view &Value) const override
+  {
+    for (const auto &Attr : Attributes)
+      if (Attr.first == Name) {
+        Value = Attr.second;
+        return true;
+      }
+    return false;
+  }
+};
+
+SCENARIO("Matching selectors against an element tree", "[matcher]")
+{
+  GIVEN("a stylesheet using every combinator")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "div li { a: 0; }\n"                // 0
+      "ul > li { a: 1; }\n"               // 1
+      "div > li { a: 2; }\n"              // 2
+      "li.first + li { a: 3; }\n"         // 3
+      "li.first ~ li { a: 4; }\n"         // 4
+      "#root .list>.item.last { a: 5; }\n"// 5
+      "li[title~=b] { a: 6; }\n"          // 6
+      "p[lang|=en] { a: 7; }\n"           // 7
+      "* { a: 8; }\n"                     // 8
+      "ul + p { a: 9; }\n"                // 9
+    );
+
+    THEN("combinators are recorded on the compound to their right")
+    {
+      REQUIRE(Sheet.Rules.size() == 10);
+      REQUIRE(Sheet.Compounds[Sheet.Selectors[1].FirstCompound + 1].LeftCombinator == Combinator::Child);
+      REQUIRE(Sheet.Compounds[Sheet.Selectors[3].FirstCompound + 1].LeftCombinator == Combinator::NextSibling);
+      REQUIRE(Sheet.Compounds[Sheet.Selectors[4].FirstCompound + 1].LeftCombinator == Combinator::SubsequentSibling);
+      REQUIRE(Sheet.Compounds[Sheet.Selectors[5].FirstCompound + 1].LeftCombinator == Combinator::Descendant);
+      REQUIRE(Sheet.Compounds[Sheet.Selectors[5].FirstCompound + 2].LeftCombinator == Combinator::Child);
+    }
+
+    /* <div id=root> <ul class=list> <li class="item first"> <li class=item title="a b"> <li class="item last"> </ul> <p lang=en-US> </div> */
+    TestElement Root("div", "root"), List("ul", "", { "list" }), Para("p");
+    TestElement First("li", "", { "item", "first" }), Second("li", "", { "item" }), Last("li", "", { "item", "last" });
+    List.AppendTo(Root);
+    Para.AppendTo(Root, &List);
+    First.AppendTo(List);
+    Second.AppendTo(List, &First);
+    Last.AppendTo(List, &Second);
+    Second.Attributes = { { "title", "a b" } };
+    Para.Attributes = { { "lang", "en-US" } };
+
+    SelectorMatcher Matcher(Sheet);
+    RuleIndex Index(Sheet);
+
+    WHEN("each element is matched against every selector")
+    {
+      std::vector<std::uint32_t> FirstMatches, SecondMatches, LastMatches, ParaMatches;
+      Matcher.CollectMatches(First, FirstMatches);
+      Matcher.CollectMatches(Second, SecondMatches);
+      Matcher.CollectMatches(Last, LastMatches);
+      Matcher.CollectMatches(Para, ParaMatches);
+
+      THEN("the combinators walk parents and previous siblings, and matches come out in cascade order")
+      {
+        REQUIRE(FirstMatches == std::vector<std::uint32_t>({ 8, 0, 1 }));
+        REQUIRE(SecondMatches == std::vector<std::uint32_t>({ 8, 0, 1, 6, 3, 4 }));
+        REQUIRE(LastMatches == std::vector<std::uint32_t>({ 8, 0, 1, 4, 5 }));
+        REQUIRE(ParaMatches == std::vector<std::uint32_t>({ 8, 9, 7 }));
+      }
+    }
+
+    WHEN("matching goes through the rule index")
+    {
+      bool SameAsFullScan = true;
+      for (const TestElement *E : { &Root, &List, &Para, &First, &Second, &Last }) {
+        std::vector<std::uint32_t> Everything, Indexed;
+        Matcher.CollectMatches(*E, Everything);
+        Matcher.CollectMatches(Index, *E, Indexed);
+        SameAsFullScan = SameAsFullScan && Everything == Indexed;
+      }
+
+      THEN("it finds exactly what trying every selector finds")
+      {
+        REQUIRE(SameAsFullScan);
+      }
+    }
+  }
+
+  GIVEN("selectors with a dangling combinator")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse("a > { x: 1; }\n b ~ c { x: 2; }");
+
+    THEN("the rule is skipped and the rest of the sheet still parses")
+    {
+      REQUIRE(Sheet.Rules.size() == 1);
+      REQUIRE(Sheet.Compounds[Sheet.Selectors[0].FirstCompound + 1].LeftCombinator == Combinator::SubsequentSibling);
+    }
+  }
+}
+
+SCENARIO("Rejecting descendant selectors with an ancestor filter", "[ancestor-filter]")
+{
+  GIVEN("descendant selectors and a generated element tree")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      ".a .b span { x: 0; }\n"
+      "#top div > p { x: 1; }\n"
+      "div ~ p em { x: 2; }\n"
+      ".missing span { x: 3; }\n"
+      "section em { x: 4; }\n"
+      "div + p { x: 5; }\n"
+    );
+
+    SelectorMatcher Matcher(Sheet);
+    AncestorFilter Filter;
+
+    THEN("only ancestor compounds contribute hashes")
+    {
+      REQUIRE(Matcher.HashesOf(0).Hash[0] == AncestorFilter::HashOf(SimpleSelectorKind::Class, "b"));
+      REQUIRE(Matcher.HashesOf(0).Hash[1] == AncestorFilter::HashOf(SimpleSelectorKind::Class, "a"));
+      REQUIRE(Matcher.HashesOf(0).Hash[2] == 0);
+      REQUIRE(Matcher.HashesOf(2).Hash[0] == AncestorFilter::HashOf(SimpleSelectorKind::Type, "p"));
+      REQUIRE(Matcher.HashesOf(2).Hash[1] == 0);
+      REQUIRE(Matcher.HashesOf(5).Hash[0] == 0);
+      REQUIRE(AncestorFilter::HashOf(SimpleSelectorKind::Class, "p") != AncestorFilter::HashOf(SimpleSelectorKind::Type, "p"));
+    }
+
+    WHEN("the tree is walked top-down, pushing each element before its children")
+    {
+      const char *Tags[] = { "div", "p", "span", "em" };
+      const char *ClassNames[] = { "a", "b", "c" };
+
+      std::vector<std::unique_ptr<TestElement>> Nodes;
+      std::size_t Visited = 0, Rejected = 0;
+      bool SameAsUnfiltered = true;
+
+      std::function<void(TestElement&, int)> Walk = [&](TestElement &Parent, int Depth)
+      {
+        TestElement *Previous = nullptr;
+        for (int i = 0; i < 3; ++i) {
+          const std::size_t n = Nodes.size();
+          Nodes.push_back(std::make_unique<TestElement>(Tags[( n * 7 + Depth ) % 4], "", std::vector<std::string>{ ClassNames[n % 3] }));
+          TestElement &Child = Nodes.back()->AppendTo(Parent, Previous);
+          Previous = &Child;
+
+          std::vector<std::uint32_t> Filtered, Unfiltered;
+          Matcher.CollectMatches(Child, Filtered, &Filter);
+          Matcher.CollectMatches(Child, Unfiltered);
+          SameAsUnfiltered = SameAsUnfiltered && Filtered == Unfiltered;
+
+          for (std::uint32_t s = 0; s < Sheet.Selectors.size(); ++s)
+            Rejected += !Filter.MightMatch(Matcher.HashesOf(s));
+          ++Visited;
+
+          if (Depth < 5) {
+            Filter.Push(Child);
+            Walk(Child, Depth + 1);
+            Filter.Pop();
+          }
+        }
+      };
+
+      TestElement Root("section", "top");
+      Filter.Push(Root);
+      Walk(Root, 0);
+      Filter.Pop();
+
+      THEN("filtered matching finds exactly what unfiltered matching finds")
+      {
+        REQUIRE(Visited == 1092);
+        REQUIRE(SameAsUnfiltered);
+      }
+
+      THEN("many selectors are rejected by the filter alone")
+      {
+        REQUIRE(Rejected > Visited);
+      }
+
+      THEN("popping every element leaves the filter empty")
+      {
+        REQUIRE(Filter.Depth() == 0);
+        REQUIRE(Filter.Empty());
+      }
+    }
+  }
+}
+
+SCENARIO("Ranking matched rules by specificity and source order", "[specificity]")
+{
+  GIVEN("selectors of every specificity")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "#a.b c { x: 0; }\n"              // 0: (1, 1, 1)
+      "* { x: 1; }\n"                   // 1: (0, 0, 0)
+      "div p.q[r=s] > em { x: 2; }\n"   // 2: (0, 2, 3)
+      ".q, em { x: 3; }\n"             // 3: (0, 1, 0), 4: (0, 0, 1)
+    );
+
+    THEN("each selector's specificity is packed when the sheet is parsed")
+    {
+      REQUIRE(Sheet.Selectors[0].Specificity == PackSpecificity(1, 1, 1));
+      REQUIRE(Sheet.Selectors[1].Specificity == 0);
+      REQUIRE(Sheet.Selectors[2].Specificity == PackSpecificity(0, 2, 3));
+      REQUIRE(Sheet.Selectors[3].Specificity == PackSpecificity(0, 1, 0));
+      REQUIRE(PackSpecificity(1, 0, 0) > PackSpecificity(0, 1023, 1023));
+      REQUIRE(PackSpecificity(0, 5000, 0) == PackSpecificity(0, 1023, 0));
+    }
+
+    THEN("the cascade order sorts by specificity, then source order")
+    {
+      std::vector<std::uint32_t> Order;
+      Sheet.CascadeOrder(Order);
+      REQUIRE(Order == std::vector<std::uint32_t>({ 1, 4, 3, 2, 0 }));
+    }
+  }
+
+  GIVEN("a large generated sheet and elements with several classes")
+  {
+    std::string Source;
+    for (int i = 0; i < 500; ++i) {
+      Source += ".c" + std::to_string(i % 7) + " { x: 1; }\n";
+      Source += "p.c" + std::to_string(i % 5) + " { x: 1; }\n";
+      Source += "#i" + std::to_string(i % 3) + " { x: 1; }\n";
+      Source += "* { x: 1; }\n";
+      Source += "div p { x: 1; }\n";
+    }
+
+    Stylesheet Sheet;
+    Sheet.Parse(Source);
+    SelectorMatcher Matcher(Sheet);
+    RuleIndex Index(Sheet);
+
+    TestElement Parent("div"), Subject("p", "i1", { "c1", "c3", "c4", "c1" });
+    Subject.AppendTo(Parent);
+
+    WHEN("matches are merged out of the index buckets")
+    {
+      std::vector<std::uint32_t> Merged, Scanned;
+      Matcher.CollectMatches(Index, Subject, Merged);
+      Matcher.CollectMatches(Subject, Scanned);
+
+      THEN("they are in the same order as a full scan in cascade order")
+      {
+        bool Ranked = std::is_sorted(Merged.begin(), Merged.end(),
+                                     [&](std::uint32_t L, std::uint32_t R) { return Sheet.CascadeKey(L) < Sheet.CascadeKey(R); });
+        REQUIRE(Merged.size() == Scanned.size());
+        REQUIRE(Merged == Scanned);
+        REQUIRE(Ranked);
+      }
+    }
+  }
+}
+
+/* A Styleable that records what it was asked and what it was given */
+struct TestStyleable : public Styleable
+{
+  std::string                        TypeName, IdName;
+  std::vector<std::string>           Classes;
+  const TestStyleable               *ParentObject = nullptr, *Previous = nullptr;
+  TestStyleable                     *FirstChild = nullptr, *Next = nullptr;
+  std::map<std::string, std::string> Properties, Attributes;
+  mutable int                        AccessorCalls = 0, AttributeCalls = 0;
+  int                                Callbacks = 0;
+
+  TestStyleable(std::string Type, std::string Id = "", std::vector<std::string> Cls = { })
+    : TypeName(std::move(Type)), IdName(std::move(Id)), Classes(std::move(Cls)) { }
+
+  std::string_view Type() const override { ++AccessorCalls; return TypeName; }
+  std::string_view Id() const override { ++AccessorCalls; return IdName; }
+  void Class(std::vector<std::string_view> &Out) const override
+  {
+    ++AccessorCalls;
+    Out.insert(Out.end(), Classes.begin(), Classes.end());
+  }
+  bool Attribute(std::string_view Name, std::string_view &Value) const override
+  {
+    ++AttributeCalls;
+    auto Found = Attributes.find(std::string(Name));
+    if (Found == Attributes.end())
+      return false;
+    Value = Found->second;
+    return true;
+  }
+
+  const Styleable* StyleParent() const override { return ParentObject; }
+  const Styleable* StylePreviousSibling() const override { return Previous; }
+  Styleable* StyleFirstChild() const override { return FirstChild; }
+  Styleable* StyleNextSibling() const override { return Next; }
+
+  void ApplyProperty(std::string_view Property, std::string_view Value) override
+  {
+    ++Callbacks;
+    Properties[std::string(Property)] = std::string(Value);
+  }
+
+  void ResetProperty(std::string_view Property) override
+  {
+    ++Callbacks;
+    Properties.erase(std::string(Property));
+  }
+
+  /* Appends Child as this object's last child */
+  TestStyleable& Adopt(TestStyleable &Child)
+  {
+    TestStyleable **Link = &FirstChild;
+    while (*Link) {
+      Child.Previous = *Link;
+      Link = &( *Link )->Next;
+    }
+    *Link = &Child;
+    Child.ParentObject = this;
+    return Child;
+  }
+};
+
+SCENARIO("Applying a stylesheet to Styleable objects", "[styleable]")
+{
+  GIVEN("a stylesheet whose rules overlap")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "button { color: black; margin: 1px; }\n"
+      "panel button.primary { color: blue; }\n"
+      "#ok { color: green; }\n"
+      "button.primary { color: red; padding: 2px; }\n"
+      "panel > label ~ button { margin: 3px; }\n"
+    );
+
+    TestStyleable Panel("panel"), Label("label"), Button("button", "", { "primary" });
+    Label.ParentObject = Button.ParentObject = &Panel;
+    Button.Previous = &Label;
+
+    WHEN("an object is styled")
+    {
+      Sheet.Apply(Button);
+
+      THEN("each property gets its cascaded value, once")
+      {
+        REQUIRE(Button.Properties["color"] == "blue");
+        REQUIRE(Button.Properties["margin"] == "3px");
+        REQUIRE(Button.Properties["padding"] == "2px");
+        REQUIRE(Button.Callbacks == 3);
+      }
+
+      THEN("every object's accessors were asked at most once")
+      {
+        REQUIRE(Button.AccessorCalls == 3);
+        REQUIRE(Panel.AccessorCalls == 3);
+        REQUIRE(Label.AccessorCalls == 3);
+      }
+    }
+
+    WHEN("several selectors test the same attributes")
+    {
+      Stylesheet Attrs;
+      Attrs.Parse(
+        "[kind] button { a: 1; }\n"
+        "[kind=box] button[role] { b: 2; }\n"
+        "panel[kind^=b] > button[role=go] { c: 3; }\n"
+        "[missing] button { d: 4; }\n"
+      );
+      Panel.Attributes["kind"] = "box";
+      Button.Attributes["role"] = "go";
+      Attrs.Apply(Button);
+
+      THEN("each object is asked about each attribute name once")
+      {
+        REQUIRE(Button.Properties.size() == 3);
+        REQUIRE(Panel.AttributeCalls == 2);
+        REQUIRE(Button.AttributeCalls == 1);
+      }
+    }
+
+    WHEN("an id rule applies and the sheet grows between calls")
+    {
+      Button.IdName = "ok";
+      Sheet.Apply(Button);
+      const std::string Before = Button.Properties["color"];
+
+      Sheet.Parse("#ok { color: white; }");
+      Sheet.Apply(Button);
+
+      THEN("the new rules are picked up")
+      {
+        REQUIRE(Before == "green");
+        REQUIRE(Button.Properties["color"] == "white");
+      }
+    }
+  }
+}
+
+/* A node type that knows nothing about the library */
+struct PlainNode
+{
+  std::string              Kind, Name;
+  std::vector<std::string> Classes;
+  const PlainNode         *Owner = nullptr, *Previous = nullptr;
+};
+
+namespace css
+{
+  template <>
+  struct ElementTraits<PlainNode>
+  {
+    static std::string_view Tag(const PlainNode &N) { return N.Kind; }
+    static std::string_view Id(const PlainNode &N) { return N.Name; }
+    static const std::vector<std::string>& Classes(const PlainNode &N) { return N.Classes; }
+    static bool Attribute(const PlainNode &, std::string_view, std::string_view &) { return false; }
+    static const PlainNode* Parent(const PlainNode &N) { return N.Owner; }
+    static const PlainNode* PreviousSibling(const PlainNode &N) { return N.Previous; }
+  };
+}
+
+SCENARIO("Matching a user node type through ElementTraits", "[element-traits]")
+{
+  GIVEN("a stylesheet and the same tree built from plain nodes and from Elements")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "div li { a: 0; }\n"
+      "ul > li.item { a: 1; }\n"
+      "li.first + li { a: 2; }\n"
+      "#root li ~ li { a: 3; }\n"
+      "* { a: 4; }\n"
+      ".missing li { a: 5; }\n"
+    );
+
+    PlainNode Root{ "div", "root", { } }, List{ "ul", "", { "list" } };
+    PlainNode First{ "li", "", { "item", "first" } }, Second{ "li", "", { "item" } };
+    List.Owner = &Root;
+    First.Owner = Second.Owner = &List;
+    Second.Previous = &First;
+
+    TestElement RootE("div", "root"), ListE("ul", "", { "list" });
+    TestElement FirstE("li", "", { "item", "first" }), SecondE("li", "", { "item" });
+    ListE.AppendTo(RootE);
+    FirstE.AppendTo(ListE);
+    SecondE.AppendTo(ListE, &FirstE);
+
+    BasicSelectorMatcher<PlainNode> PlainMatcher(Sheet);
+    SelectorMatcher VirtualMatcher(Sheet);
+    RuleIndex Index(Sheet);
+
+    WHEN("the leaves are matched with an ancestor filter")
+    {
+      AncestorFilter PlainFilter, VirtualFilter;
+      PlainFilter.Push(Root);
+      PlainFilter.Push(List);
+      VirtualFilter.Push(RootE);
+      VirtualFilter.Push(ListE);
+
+      std::vector<std::uint32_t> Plain, Virtual;
+      PlainMatcher.CollectMatches(Index, Second, Plain, &PlainFilter);
+      VirtualMatcher.CollectMatches(Index, SecondE, Virtual, &VirtualFilter);
+
+      THEN("both matchers agree")
+      {
+        REQUIRE(Plain == std::vector<std::uint32_t>({ 4, 0, 1, 2, 3 }));
+        REQUIRE(Plain == Virtual);
+        REQUIRE(PlainMatcher.Matches(1, First));
+        REQUIRE_FALSE(PlainMatcher.Matches(2, First));
+      }
+    }
+  }
+}
+
+/* PlainNode, counting how often the matcher reads names off it */
+struct CountedNode : PlainNode
+{
+  const CountedNode *Up = nullptr, *Before = nullptr;
+  static int Lookups;
+};
+
+int CountedNode::Lookups = 0;
+
+namespace css
+{
+  template <>
+  struct ElementTraits<CountedNode>
+  {
+    static std::string_view Tag(const CountedNode &N) { ++CountedNode::Lookups; return N.Kind; }
+    static std::string_view Id(const CountedNode &N) { ++CountedNode::Lookups; return N.Name; }
+    static const std::vector<std::string>& Classes(const CountedNode &N) { ++CountedNode::Lookups; return N.Classes; }
+    static bool Attribute(const CountedNode &, std::string_view, std::string_view &) { return false; }
+    static const CountedNode* Parent(const CountedNode &N) { return N.Up; }
+    static const CountedNode* PreviousSibling(const CountedNode &N) { return N.Before; }
+  };
+}
+
+/* CountedNode, carrying its names already interned against one sheet */
+struct InternedNode : CountedNode
+{
+  const InternedNode *UpInterned = nullptr, *BeforeInterned = nullptr;
+  Atom                TagKey = NullAtom, IdKey = NullAtom;
+  std::vector<Atom>   ClassKeys;
+
+  void Intern(const Stylesheet &Sheet)
+  {
+    TagKey = Sheet.Atoms.Find(Kind);
+    IdKey = Name.empty() ? NullAtom : Sheet.Atoms.Find(Name);
+    ClassKeys.clear();
+    for (const std::string &Class : Classes)
+      if (Sheet.Atoms.Find(Class) != NullAtom)
+        ClassKeys.push_back(Sheet.Atoms.Find(Class));
+  }
+};
+
+namespace css
+{
+  template <>
+  struct ElementTraits<InternedNode> : ElementTraits<CountedNode>
+  {
+    static ElementKeys Keys(const InternedNode &N, const Stylesheet &)
+    {
+      ElementKeys Keys;
+      Keys.Tag = N.TagKey;
+      Keys.Id = N.IdKey;
+      Keys.Classes = N.ClassKeys.data();
+      Keys.ClassCount = N.ClassKeys.size();
+      return Keys;
+    }
+    static const InternedNode* Parent(const InternedNode &N) { return N.UpInterned; }
+    static const InternedNode* PreviousSibling(const InternedNode &N) { return N.BeforeInterned; }
+  };
+}
+
+SCENARIO("Looking up each element's names once per match", "[element-keys]")
+{
+  GIVEN("a stylesheet whose selectors walk over the same ancestors and siblings many times")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "div li { a: 0; }\n"
+      "div ul li { a: 1; }\n"
+      "#root .list > li { a: 2; }\n"
+      "li.first ~ li { a: 3; }\n"
+      "ul li.item { a: 4; }\n"
+      ".missing li { a: 5; }\n"
+      "span li { a: 6; }\n"
+    );
+
+    CountedNode Root, List, First, Second;
+    Root.Kind = "div";
+    Root.Name = "root";
+    List.Kind = "ul";
+    List.Classes = { "list" };
+    First.Kind = Second.Kind = "li";
+    First.Classes = { "item", "first" };
+    Second.Classes = { "item", "other" };
+    List.Up = &Root;
+    First.Up = Second.Up = &List;
+    Second.Before = &First;
+
+    BasicSelectorMatcher<CountedNode> Matcher(Sheet);
+
+    WHEN("every selector is tried against the last item")
+    {
+      CountedNode::Lookups = 0;
+      std::vector<std::uint32_t> Matched;
+      Matcher.CollectMatches(Second, Matched);
+
+      THEN("the tag, id and classes of each element reached are read once")
+      {
+        REQUIRE(Matched == std::vector<std::uint32_t>({ 0, 1, 3, 4, 2 }));
+        REQUIRE(CountedNode::Lookups == 4 * 3);
+      }
+    }
+
+    WHEN("it is matched again after a class changes")
+    {
+      std::vector<std::uint32_t> Matched;
+      Matcher.CollectMatches(Second, Matched);
+      First.Classes = { "item" };
+      Matched.clear();
+      Matcher.CollectMatches(Second, Matched);
+
+      THEN("nothing looked up by the earlier call is reused")
+      {
+        REQUIRE(Matched == std::vector<std::uint32_t>({ 0, 1, 4, 2 }));
+      }
+    }
+
+    WHEN("the nodes bring their own atoms")
+    {
+      InternedNode IRoot, IList, IFirst, ISecond;
+      static_cast<CountedNode&>(IRoot) = Root;
+      static_cast<CountedNode&>(IList) = List;
+      static_cast<CountedNode&>(IFirst) = First;
+      static_cast<CountedNode&>(ISecond) = Second;
+      IList.UpInterned = &IRoot;
+      IFirst.UpInterned = ISecond.UpInterned = &IList;
+      ISecond.BeforeInterned = &IFirst;
+      for (InternedNode *Node : { &IRoot, &IList, &IFirst, &ISecond })
+        Node->Intern(Sheet);
+
+      BasicSelectorMatcher<InternedNode> InternedMatcher(Sheet);
+      CountedNode::Lookups = 0;
+      std::vector<std::uint32_t> Matched;
+      InternedMatcher.CollectMatches(ISecond, Matched);
+
+      THEN("no names are read or looked up")
+      {
+        REQUIRE(Matched == std::vector<std::uint32_t>({ 0, 1, 3, 4, 2 }));
+        REQUIRE(CountedNode::Lookups == 0);
+      }
+    }
+  }
+
+  GIVEN("an element below a long chain of ancestors")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      ".missing li { a: 0; }\n"
+      "section div li { a: 1; }\n"
+      "p div div li { a: 2; }\n"
+      "div div li { a: 3; }\n"
+    );
+
+    std::vector<CountedNode> Chain(64);
+    for (std::size_t i = 0; i < Chain.size(); ++i) {
+      Chain[i].Kind = "div";
+      Chain[i].Up = i ? &Chain[i - 1] : nullptr;
+    }
+    CountedNode Leaf;
+    Leaf.Kind = "li";
+    Leaf.Up = &Chain.back();
+
+    BasicSelectorMatcher<CountedNode> Matcher(Sheet);
+
+    WHEN("selectors walk all the way up, again and again")
+    {
+      CountedNode::Lookups = 0;
+      std::vector<std::uint32_t> Matched;
+      Matcher.CollectMatches(Leaf, Matched);
+
+      THEN("each ancestor is still read once")
+      {
+        REQUIRE(Matched == std::vector<std::uint32_t>({ 3 }));
+        REQUIRE(CountedNode::Lookups == 65 * 3);
+      }
+    }
+  }
+}
+
+SCENARIO("Restyling only what a change can affect", "[restyle]")
+{
+  GIVEN("a styled tree")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "li { color: black; }\n"
+      ".open li { color: red; }\n"
+      "li.sel { weight: bold; }\n"
+      "li.mark ~ li { margin: 1px; }\n"
+      "li.same { color: black; }\n"
+    );
+
+    TestStyleable Root("div"), List("ul"), Sidebar("aside"), SideItem("li");
+    std::vector<std::unique_ptr<TestStyleable>> Items;
+    Root.Adopt(List);
+    Root.Adopt(Sidebar);
+    Sidebar.Adopt(SideItem);
+    for (int i = 0; i < 5; ++i) {
+      Items.push_back(std::make_unique<TestStyleable>("li"));
+      List.Adopt(*Items.back());
+    }
+
+    RestyleEngine Engine(Sheet);
+    Engine.StyleTree(Root);
+
+    auto TotalCallbacks = [&]()
+    {
+      int Total = Root.Callbacks + List.Callbacks + Sidebar.Callbacks + SideItem.Callbacks;
+      for (const auto &Item : Items)
+        Total += Item->Callbacks;
+      return Total;
+    };
+    const int Initial = TotalCallbacks();
+
+    THEN("every object is styled once")
+    {
+      REQUIRE(Engine.RestyleCount() == 9);
+      REQUIRE(Initial == 6);
+      REQUIRE(Engine.StyleOf(*Items[0])->MatchedSelectors.size() == 1);
+    }
+
+    WHEN("a class only used in subject position is added")
+    {
+      Items[2]->Classes.push_back("sel");
+      Engine.ClassChanged(*Items[2], "sel");
+
+      THEN("only that object is restyled and only the new property fires")
+      {
+        REQUIRE(Engine.RestyleCount() == 10);
+        REQUIRE(TotalCallbacks() == Initial + 1);
+        REQUIRE(Items[2]->Properties["weight"] == "bold");
+      }
+
+      AND_WHEN("it is removed again")
+      {
+        Items[2]->Classes.clear();
+        Engine.ClassChanged(*Items[2], "sel");
+
+        THEN("the property is reset")
+        {
+          REQUIRE(Items[2]->Properties.count("weight") == 0);
+          REQUIRE(TotalCallbacks() == Initial + 2);
+        }
+      }
+    }
+
+    WHEN("a class used in ancestor position is added")
+    {
+      List.Classes.push_back("open");
+      Engine.ClassChanged(List, "open");
+
+      THEN("its subtree is restyled, but not the object itself or the rest of the tree")
+      {
+        REQUIRE(Engine.RestyleCount() == 9 + 5);
+        REQUIRE(Items[4]->Properties["color"] == "red");
+        REQUIRE(SideItem.Properties["color"] == "black");
+        REQUIRE(TotalCallbacks() == Initial + 5);
+      }
+    }
+
+    WHEN("a class used in sibling position is added")
+    {
+      Items[1]->Classes.push_back("mark");
+      Engine.ClassChanged(*Items[1], "mark");
+
+      THEN("only the later siblings are restyled")
+      {
+        REQUIRE(Engine.RestyleCount() == 9 + 3);
+        REQUIRE(Items[0]->Properties.count("margin") == 0);
+        REQUIRE(Items[3]->Properties["margin"] == "1px");
+      }
+    }
+
+    WHEN("a change leaves every value as it was")
+    {
+      Items[0]->Classes.push_back("same");
+      Engine.ClassChanged(*Items[0], "same");
+      Engine.ClassChanged(*Items[0], "unknown");
+
+      THEN("nothing fires, and unknown names restyle nothing")
+      {
+        REQUIRE(Engine.RestyleCount() == 10);
+        REQUIRE(TotalCallbacks() == Initial);
+      }
+    }
+  }
+}
+
+SCENARIO("Building invalidation sets from a stylesheet", "[invalidation]")
+{
+  GIVEN("selectors naming classes, ids and attributes in every position")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      ".open li.x { a: 0; }\n"          // 0
+      ".open { a: 1; }\n"               // 1
+      "#main .open * { a: 2; }\n"       // 2
+      ".mark ~ div span { a: 3; }\n"    // 3
+      "p[title=x] + em { a: 4; }\n"     // 4
+    );
+
+    InvalidationSets Sets(Sheet);
+
+    THEN("each name lists the selectors that mention it and where")
+    {
+      const InvalidationSet *Open = Sets.Find(SimpleSelectorKind::Class, Sheet.Atoms.Find("open"));
+      REQUIRE(Open != nullptr);
+      REQUIRE(Open->Entries.size() == 3);
+      REQUIRE(Open->Entries[0].Selector == 0);
+      REQUIRE(Open->Entries[0].Position == InvalidationPosition::Ancestor);
+      REQUIRE(Open->Entries[1].Position == InvalidationPosition::Subject);
+      REQUIRE(Open->Self);
+      REQUIRE(Open->AllDescendants);
+      REQUIRE_FALSE(Open->AffectsSiblings());
+
+      const InvalidationSet *Main = Sets.Find(SimpleSelectorKind::ID, Sheet.Atoms.Find("main"));
+      REQUIRE(Main != nullptr);
+      REQUIRE_FALSE(Main->Self);
+      REQUIRE(Main->AllDescendants);
+
+      const InvalidationSet *Mark = Sets.Find(SimpleSelectorKind::Class, Sheet.Atoms.Find("mark"));
+      REQUIRE(Mark->SiblingKeys == std::vector<FeatureKey>{ MakeFeatureKey(BucketKind::Type, Sheet.Atoms.Find("span")) });
+      REQUIRE(Mark->SiblingDescendants);
+      REQUIRE_FALSE(Mark->AffectsDescendants());
+
+      const InvalidationSet *Title = Sets.Find(SimpleSelectorKind::Attribute, Sheet.Atoms.Find("title"));
+      REQUIRE(Title->SiblingKeys == std::vector<FeatureKey>{ MakeFeatureKey(BucketKind::Type, Sheet.Atoms.Find("em")) });
+      REQUIRE_FALSE(Title->SiblingDescendants);
+
+      REQUIRE(Sets.Find(SimpleSelectorKind::ID, Sheet.Atoms.Find("open")) == nullptr);
+      REQUIRE(Sets.Find(SimpleSelectorKind::Class, Sheet.Atoms.Find("li")) == nullptr);
+    }
+  }
+
+  GIVEN("a restyle engine over a list where only some items can be affected")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(".open li.x { color: red; }\n");
+
+    TestStyleable List("ul");
+    std::vector<std::unique_ptr<TestStyleable>> Items;
+    for (int i = 0; i < 10; ++i) {
+      Items.push_back(std::make_unique<TestStyleable>("li", "", std::vector<std::string>{ i % 5 == 0 ? "x" : "y" }));
+      List.Adopt(*Items.back());
+    }
+
+    RestyleEngine Engine(Sheet);
+    Engine.StyleTree(List);
+
+    WHEN("the ancestor class changes")
+    {
+      List.Classes.push_back("open");
+      Engine.ClassChanged(List, "open");
+
+      THEN("only the descendants carrying the subject key are restyled")
+      {
+        REQUIRE(Engine.RestyleCount() + Engine.SharedCount() == 11 + 2);
+        REQUIRE(Items[5]->Properties["color"] == "red");
+        REQUIRE(Items[6]->Properties.empty());
+      }
+    }
+  }
+}
+
+SCENARIO("Filtering ancestors while styling a tree", "[restyle-filter]")
+{
+  GIVEN("a tree styled by an engine")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "li { color: black; }\n"
+      ".menu li { color: red; }\n"
+      ".missing li { color: blue; }\n"
+      "ul > li { margin: 1px; }\n"
+    );
+
+    TestStyleable Root("div", "", { "menu" }), List("ul");
+    std::vector<std::unique_ptr<TestStyleable>> Items;
+    Root.Adopt(List);
+    for (const char *Id : { "a", "b", "c" }) {
+      Items.push_back(std::make_unique<TestStyleable>("li", Id));
+      List.Adopt(*Items.back());
+    }
+
+    RestyleEngine Engine(Sheet);
+    Engine.StyleTree(Root);
+
+    THEN("a selector needing an ancestor the path lacks is rejected without walking up")
+    {
+      REQUIRE(Engine.RestyleCount() == 5);
+      REQUIRE(Engine.FilterRejections() == 3);
+    }
+
+    THEN("every object matches what an unfiltered resolver matches")
+    {
+      StyleResolver Plain(Sheet);
+      for (const TestStyleable *Object : { &Root, &List, Items[0].get(), Items[1].get(), Items[2].get() }) {
+        std::vector<std::uint32_t> Expected;
+        Plain.Match(*Object, Expected);
+        REQUIRE(Engine.StyleOf(*Object)->MatchedSelectors == Expected);
+      }
+      REQUIRE(Engine.StyleOf(*Items[1])->MatchedSelectors.size() == 3);
+      REQUIRE(Plain.FilterRejections() == 0);
+    }
+
+    WHEN("one object is restyled on its own")
+    {
+      Engine.Restyle(*Items[1]);
+
+      THEN("the filter is rebuilt from its ancestors")
+      {
+        REQUIRE(Engine.FilterRejections() == 4);
+        REQUIRE(Engine.StyleOf(*Items[1])->MatchedSelectors.size() == 3);
+      }
+    }
+  }
+}
+
+SCENARIO("Sharing styles between equivalent siblings", "[style-sharing]")
+{
+  GIVEN("a long list of mostly identical items")
+  {
+    TestStyleable List("ul");
+    std::vector<std::unique_ptr<TestStyleable>> Items;
+    for (int i = 0; i < 100; ++i) {
+      Items.push_back(std::make_unique<TestStyleable>("li", "", std::vector<std::string>{ i % 10 == 0 ? "odd" : "row" }));
+      List.Adopt(*Items.back());
+    }
+    Items[50]->Attributes["title"] = "t";
+
+    WHEN("the sheet can't tell the identical items apart")
+    {
+      Stylesheet Sheet;
+      Sheet.Parse(
+        "li { color: red; }\n"
+        "ul .odd { color: blue; }\n"
+        "li[title=t] { weight: bold; }\n"
+        "ul + ul li { margin: 0; }\n"
+      );
+
+      RestyleEngine Engine(Sheet);
+      Engine.StyleTree(List);
+
+      THEN("only one of each kind of item is matched and the rest share its style")
+      {
+        REQUIRE(Engine.RestyleCount() == 4);
+        REQUIRE(Engine.SharedCount() == 97);
+        REQUIRE(Items[99]->Properties["color"] == "red");
+        REQUIRE(Items[90]->Properties["color"] == "blue");
+        REQUIRE(Items[50]->Properties["weight"] == "bold");
+        REQUIRE(Items[51]->Properties.count("weight") == 0);
+      }
+    }
+
+    WHEN("the sheet has a selector that tells siblings apart by position")
+    {
+      Stylesheet Sheet;
+      Sheet.Parse(
+        "li { color: red; }\n"
+        ".row + .row { color: green; }\n"
+      );
+
+      RestyleEngine Engine(Sheet);
+      Engine.StyleTree(List);
+
+      THEN("items carrying its subject key are never shared")
+      {
+        REQUIRE(Engine.RestyleCount() == 1 + 90 + 1);
+        REQUIRE(Engine.SharedCount() == 9);
+        REQUIRE(Items[1]->Properties["color"] == "red");
+        REQUIRE(Items[2]->Properties["color"] == "green");
+      }
+    }
+  }
+}
+
+SCENARIO("Caching cascaded styles by matched rules", "[declaration-cache]")
+{
+  GIVEN("objects in different parts of a tree that match the same rules")
+  {
+    Stylesheet Sheet;
+    Sheet.Parse(
+      "li { color: red; }\n"
+      ".a, .b { margin: 1px; }\n"
+      "div li { padding: 2px; }\n"
+    );
+
+    TestStyleable Root("div"), Left("ul"), Right("ol");
+    TestStyleable One("li", "", { "a" }), Two("li", "", { "b" }), Three("li", "", { "a" }), Plain("li");
+    Root.Adopt(Left);
+    Root.Adopt(Right);
+    Left.Adopt(One);
+    Right.Adopt(Two);
+    Right.Adopt(Three);
+    Right.Adopt(Plain);
+
+    RestyleEngine Engine(Sheet);
+    Engine.StyleTree(Root);
+    const MatchedDeclarationsCache &Cache = Engine.DeclarationCache();
+
+    THEN("the cascade runs once per distinct rule list")
+    {
+      /* div, ul and ol match nothing: one miss, then hits.  .a and .b are one rule */
+      REQUIRE(Cache.Misses() == 3);
+      REQUIRE(Cache.Hits() == 4);
+      REQUIRE(Cache.Size() == 3);
+      REQUIRE(Two.Properties == One.Properties);
+      REQUIRE(Plain.Properties.count("margin") == 0);
+      REQUIRE(Plain.Properties["padding"] == "2px");
+    }
+  }
+
+  GIVEN("a cache with only two slots")
+  {
+    MatchedDeclarationsCache Cache(2);
+    const std::vector<ResolvedProperty> Style = { { 1, 0 } };
+
+    WHEN("more rule lists are inserted than it has room for")
+    {
+      for (std::uint32_t i = 0; i < 10; ++i) {
+        const std::vector<std::uint32_t> Rules = { i, i + 1 };
+        Cache.Insert(Rules, MatchedDeclarationsCache::HashOf(Rules), Style);
+      }
+
+      THEN("it never holds more than its capacity")
+      {
+        REQUIRE(Cache.Capacity() == 2);
+        REQUIRE(Cache.Size() == 2);
+      }
+    }
+
+    WHEN("two rule lists are given the same hash")
+    {
+      const std::vector<std::uint32_t> First = { 1, 2 }, Second = { 2, 1 };
+      Cache.Insert(First, 42, Style);
+
+      THEN("the other list misses instead of getting the wrong style")
+      {
+        REQUIRE(Cache.Find(First, 42) != nullptr);
+        REQUIRE(Cache.Find(Second, 42) == nullptr);
+        REQUIRE(Cache.Hits() == 1);
+        REQUIRE(Cache.Misses() == 1);
+      }
+    }
+  }
+}
+
+static_assert(LookupProperty("color") == PropertyId::Color, "property ids resolve at compile time");
+static_assert(PropertyName(PropertyId::ZIndex) == "z-index", "property names resolve at compile time");
+
+SCENARIO("Property names resolve to a fixed id", "[property-id]")
+{
+  GIVEN("the known property names")
+  {
+    THEN("every name maps back to its own id")
+    {
+      bool RoundTrips = true;
+      for (std::size_t p = ( std::size_t )PropertyId::Custom + 1; p < ( std::size_t )PropertyId::Count; ++p)
+        RoundTrips = RoundTrips && LookupProperty(PropertyName(( PropertyId )p)) == ( PropertyId )p;
+      REQUIRE(RoundTrips);
+    }
+
+    THEN("lookups ignore case, and custom or unknown names are told apart")
+    {
+      REQUIRE(LookupProperty("Background-COLOR") == PropertyId::BackgroundColor);
+      REQUIRE(LookupProperty("--accent") == PropertyId::Custom);
+      REQUIRE(LookupProperty("colour") == PropertyId::Unknown);
+      REQUIRE(LookupProperty("") == PropertyId::Unknown);
+      REQUIRE(LookupProperty("--") == PropertyId::Unknown);
+    }
+  }
+
+  GIVEN("a stylesheet with known and unknown properties")
+  {
+    Stylesheet Sheet;
+    REQUIRE(Sheet.Parse("p { margin: 0; Color: red; colour: red; }"));
+
+    THEN("each declaration carries its id and keeps its text")
+    {
+      REQUIRE(Sheet.Declarations.size() == 3);
+      REQUIRE(Sheet.Declarations[0].Id == PropertyId::Margin);
+      REQUIRE(Sheet.Declarations[1].Id == PropertyId::Color);
+      REQUIRE(Sheet.Declarations[2].Id == PropertyId::Unknown);
+      REQUIRE(Sheet.Atoms.TextOf(Sheet.Declarations[2].Property) == "colour");
+    }
+  }
+}
+
+SCENARIO("Declaration values are parsed once into typed values", "[values]")
+{
+  GIVEN("declarations with each kind of value")
+  {
+    Stylesheet Sheet;
+    REQUIRE(Sheet.Parse(R"(p {
+                             width: 12.5px;
+                             height: 50%;
+                             z-index: -3;
+                             color: #FF8000;
+                             background-color: #0f08;
+                             display: Block;
+                             border: 1px solid black;
+                             font-family: "Open Sans", serif;
+                             transform: translate(10px, -2em) rotate(45deg);
+                             background-image: url(images/bg.png);
+                             font: 12px/1.5 serif;
+                             margin: ;
+                             content: [x];
+                           })"));
+
+    auto Value = [&Sheet](std::size_t Declaration) { return Sheet.ValueOf(( std::uint32_t )Declaration); };
+
+    THEN("numbers, percentages and dimensions keep their number and unit")
+    {
+      REQUIRE(Value(0).Kind() == ValueKind::Dimension);
+      REQUIRE(Value(0).Number() == 12.5f);
+      REQUIRE(Value(0).Name() == "px");
+      REQUIRE(Value(1).Kind() == ValueKind::Percentage);
+      REQUIRE(Value(1).Number() == 50.0f);
+      REQUIRE(Value(2).Kind() == ValueKind::Number);
+      REQUIRE(Value(2).Number() == -3.0f);
+    }
+
+    THEN("hex colors are packed as RGBA and keywords are folded to lower case")
+    {
+      REQUIRE(Value(3).Kind() == ValueKind::Color);
+      REQUIRE(Value(3).Color() == PackColor(255, 128, 0));
+      REQUIRE(Value(4).Color() == PackColor(0, 255, 0, 136));
+      REQUIRE(Value(5).Kind() == ValueKind::Keyword);
+      REQUIRE(Value(5).Name() == "block");
+      REQUIRE(Value(5).Text() == "Block");
+    }
+
+    THEN("whitespace and commas make lists")
+    {
+      const ValueView Border = Value(6);
+      REQUIRE(Border.Kind() == ValueKind::List);
+      REQUIRE(!Border.IsComma());
+      REQUIRE(Border.Count() == 3);
+      REQUIRE(Border.Child(0).Kind() == ValueKind::Dimension);
+      REQUIRE(Border.Child(1).Name() == "solid");
+      REQUIRE(Border.Child(2).Color() == PackColor(0, 0, 0));
+      REQUIRE(Border.Text() == "1px solid black");
+
+      const ValueView Fonts = Value(7);
+      REQUIRE(Fonts.IsComma());
+      REQUIRE(Fonts.Count() == 2);
+      REQUIRE(Fonts.Child(0).Kind() == ValueKind::String);
+      REQUIRE(Fonts.Child(0).Text() == "Open Sans");
+      REQUIRE(Fonts.Child(1).Name() == "serif");
+    }
+
+    THEN("functions hold their arguments, and nested values can be skipped over")
+    {
+      const ValueView Transform = Value(8);
+      REQUIRE(Transform.Count() == 2);
+      REQUIRE(Transform.Child(0).Kind() == ValueKind::Function);
+      REQUIRE(Transform.Child(0).Name() == "translate");
+      REQUIRE(Transform.Child(0).Count() == 2);
+      REQUIRE(Transform.Child(0).Child(1).Number() == -2.0f);
+      REQUIRE(Transform.Child(0).Child(1).Name() == "em");
+      REQUIRE(Transform.Child(1).Name() == "rotate");
+      REQUIRE(Transform.Child(1).Child(0).Number() == 45.0f);
+
+      REQUIRE(Value(9).Name() == "url");
+      REQUIRE(Value(9).Child(0).Text() == "images/bg.png");
+    }
+
+    THEN("loose characters are kept, and what can't be parsed is kept as text")
+    {
+      const ValueView Font = Value(10);
+      REQUIRE(Font.Count() == 4);
+      REQUIRE(Font.Child(1).Kind() == ValueKind::Delimiter);
+      REQUIRE(Font.Child(1).Text() == "/");
+      REQUIRE(Font.Child(2).Number() == 1.5f);
+      REQUIRE(Value(11).Kind() == ValueKind::None);
+      REQUIRE(Value(12).Kind() == ValueKind::Raw);
+      REQUIRE(Value(12).Text() == "[x]");
+    }
+  }
+
+  GIVEN("a Styleable that reads typed values")
+  {
+    struct TypedStyleable : public Styleable
+    {
+      std::string_view Type() const override { return "p"; }
+      void ApplyProperty(std::string_view /*Property*/, std::string_view /*Value*/) override { ++TextCalls; }
+      void ApplyValue(PropertyId Id, std::string_view /*Property*/, std::string_view /*Text*/, const ValueView &Value) override
+      {
+        if (Id == PropertyId::Width && Value.Kind() == ValueKind::Dimension)
+          Width = Value.Number();
+      }
+
+      float Width = 0;
+      int TextCalls = 0;
+    } Object;
+
+    Stylesheet Sheet;
+    Sheet.Parse("p { width: 320px; }");
+    Sheet.Apply(Object);
+
+    THEN("it gets the parsed value instead of the text")
+    {
+      REQUIRE(Object.Width == 320.0f);
+      REQUIRE(Object.TextCalls == 0);
+    }
+  }
+
+  GIVEN("a value whose tokens stop before a color function's closing parenthesis")
+  {
+    const std::string_view Source = "rgb(1, 2, 3)";
+    std::pmr::vector<Token> Tokens;
+    Tokenize(Source, Tokens);
+    REQUIRE(Tokens[Tokens.size() - 2].Kind == TokenKind::RightParen);
+
+    std::pmr::vector<ValueRecord> Values;
+    AtomTable Atoms;
+    ValueParser Parser(Values, Atoms);
+    TextRef Stored;
+    Stored.Length = ( std::uint32_t )Source.size() - 1;
+    const std::uint32_t Root = Parser.Parse(Tokens.data(), Tokens.data() + Tokens.size() - 2, Source, Stored);
+
+    THEN("the color parser doesn't read past the value")
+    {
+      REQUIRE(Values[Root].Kind == ValueKind::Raw);
+      REQUIRE(Values[Root].Text.Length == Stored.Length);
+    }
+  }
+}
+
+static_assert([] { std::uint32_t Color = 0; return LookupNamedColor("RebeccaPurple", Color) && Color == PackColor(0x66, 0x33, 0x99); }(),
+              "named colors resolve at compile time");
+
+SCENARIO("Parsing colors", "[colors]")
+{
+  auto Parsed = [](std::string_view Text) {
+    std::uint32_t Color = 0xDEADBEEF;
+    return ParseColor(Text, Color) == Text.size() ? Color : 0xDEADBEEF;
+  };
+
+  GIVEN("hex colors")
+  {
+    THEN("every length is decoded, and missing alpha is opaque")
+    {
+      REQUIRE(Parsed("#f80") == PackColor(0xFF, 0x88, 0x00));
+      REQUIRE(Parsed("#f808") == PackColor(0xFF, 0x88, 0x00, 0x88));
+      REQUIRE(Parsed("#1A2b3C") == PackColor(0x1A, 0x2B, 0x3C));
+      REQUIRE(Parsed("#1a2b3c4d") == PackColor(0x1A, 0x2B, 0x3C, 0x4D));
+    }
+
+    THEN("bad digits and lengths are rejected")
+    {
+      std::uint32_t Color = 0;
+      REQUIRE(ParseColor("#12345", Color) == 0);
+      REQUIRE(ParseColor("#12g", Color) == 0);
+      REQUIRE(ParseColor("#", Color) == 0);
+      REQUIRE(Color == 0);
+    }
+  }
+
+  GIVEN("named colors")
+  {
+    THEN("every name is found, ignoring case")
+    {
+      bool AllFound = true;
+      for (const auto &Named : Detail::NamedColors)
+        AllFound = AllFound && Parsed(Named.Name) == Named.Color;
+      REQUIRE(AllFound);
+      REQUIRE(Detail::NamedColorCount == 149);
+      REQUIRE(Parsed("CornflowerBlue") == PackColor(0x64, 0x95, 0xED));
+      REQUIRE(Parsed("transparent") == PackColor(0, 0, 0, 0));
+    }
+
+    THEN("other words are not colors")
+    {
+      std::uint32_t Color = 0;
+      REQUIRE(ParseColor("solid", Color) == 0);
+      REQUIRE(ParseColor("reds", Color) == 0);
+      REQUIRE(ParseColor("red_x", Color) == 0);
+    }
+  }
+
+  GIVEN("color functions")
+  {
+    THEN("the comma and space forms give the same color")
+    {
+      REQUIRE(Parsed("rgb(255, 128, 0)") == PackColor(255, 128, 0));
+      REQUIRE(Parsed("rgba(255, 128, 0, 0.5)") == PackColor(255, 128, 0, 128));
+      REQUIRE(Parsed("rgb(255 128 0 / 50%)") == PackColor(255, 128, 0, 128));
+      REQUIRE(Parsed("RGB( 100% , 0%, 0% )") == PackColor(255, 0, 0));
+      REQUIRE(Parsed("rgb(300, -5, 0)") == PackColor(255, 0, 0));
+    }
+
+    THEN("hsl is converted to rgb")
+    {
+      REQUIRE(Parsed("hsl(0, 100%, 50%)") == PackColor(255, 0, 0));
+      REQUIRE(Parsed("hsl(120deg 100% 25%)") == PackColor(0, 128, 0));
+      REQUIRE(Parsed("hsla(0.5turn, 100%, 50%, 0)") == PackColor(0, 255, 255, 0));
+      REQUIRE(Parsed("hsl(0, 0%, 100%)") == PackColor(255, 255, 255));
+    }
+
+    THEN("malformed functions are rejected")
+    {
+      std::uint32_t Color = 0;
+      REQUIRE(ParseColor("rgb(1, 2)", Color) == 0);
+      REQUIRE(ParseColor("rgb(1, 2, 3", Color) == 0);
+      REQUIRE(ParseColor("rgb(a, b, c)", Color) == 0);
+      REQUIRE(ParseColor("rgb(1, 2, 3, 4, 5)", Color) == 0);
+      REQUIRE(ParseColor("lab(1, 2, 3)", Color) == 0);
+    }
+  }
+
+  GIVEN("colors in a stylesheet")
+  {
+    Stylesheet Sheet;
+    REQUIRE(Sheet.Parse("p { color: rgba(0, 1, 1, 1); border: 1px solid Red; background: #000 url(x.png); }"));
+
+    THEN("they are stored as packed colors")
+    {
+      REQUIRE(Sheet.ValueOf(0).Kind() == ValueKind::Color);
+      REQUIRE(Sheet.ValueOf(0).Color() == PackColor(0, 1, 1, 255));
+      REQUIRE(Sheet.ValueOf(0).Text() == "rgba(0, 1, 1, 1)");
+      REQUIRE(Sheet.ValueOf(1).Child(2).Color() == PackColor(255, 0, 0));
+      REQUIRE(Sheet.ValueOf(1).Child(2).Text() == "Red");
+      REQUIRE(Sheet.ValueOf(2).Child(0).Color() == PackColor(0, 0, 0));
+      REQUIRE(Sheet.ValueOf(2).Child(1).Name() == "url");
+    }
+  }
+}
+
+/* Hidden; run with "[.benchmark]" or "[colors-benchmark]" */
+SCENARIO("Color parsing throughput", "[.benchmark][colors-benchmark]")
+{
+  GIVEN("a mix of the color forms stylesheets use")
+  {
+    const std::vector<std::string> Samples = {
+      "#fff", "#1a2b3c", "#1a2b3c80", "white", "black", "transparent", "cornflowerblue",
+      "rgb(255, 128, 0)", "rgba(0, 0, 0, 0.5)", "rgb(10 20 30 / 40%)", "hsl(210, 50%, 40%)"
+    };
+    const std::size_t Rounds = 200000;
+
+    WHEN("each is parsed many times")
+    {
+      std::uint32_t Checksum = 0;
+      const auto Start = std::chrono::steady_clock::now();
+      for (std::size_t r = 0; r < Rounds; ++r) {
+        for (const std::string &Sample : Samples) {
+          std::uint32_t Color = 0;
+          ParseColor(Sample, Color);
+          Checksum += Color;
+        }
+      }
+      const auto Elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+
+      THEN("the time per color is reported")
+      {
+        WARN("ParseColor: " << Elapsed / ( double )( Rounds * Samples.size() ) << " ns per color (checksum " << Checksum << ")");
+        REQUIRE(Checksum != 0);
+      }
+    }
+  }
+}
+
+static_assert(LookupUnit("px") == UnitId::Px && LookupUnit("VMIN") == UnitId::Vmin, "units resolve at compile time");
+static_assert(LookupUnit("pixels") == UnitId::Unknown && LookupUnit("") == UnitId::Unknown, "unknown units are Unknown");
+
+SCENARIO("Parsing numbers and dimensions", "[units]")
+{
+  auto Parsed = [](std::string_view Text, Dimension &Value) { return ParseDimension(Text, Value) == Text.size(); };
+
+  GIVEN("numbers with and without units")
+  {
+    Dimension Value;
+
+    THEN("the number and the unit are read together")
+    {
+      REQUIRE(Parsed("12px", Value));
+      REQUIRE(Value.Number == 12.0f);
+      REQUIRE(Value.Unit == UnitId::Px);
+      REQUIRE(Parsed("1.5EM", Value));
+      REQUIRE(Value.Number == 1.5f);
+      REQUIRE(Value.Unit == UnitId::Em);
+      REQUIRE(Parsed("50%", Value));
+      REQUIRE(Value.Unit == UnitId::Percent);
+      REQUIRE(Parsed("-3", Value));
+      REQUIRE(Value.Number == -3.0f);
+      REQUIRE(Value.Unit == UnitId::None);
+      REQUIRE(Parsed("+.5e1Q", Value));
+      REQUIRE(Value.Number == 5.0f);
+      REQUIRE(Value.Unit == UnitId::Q);
+    }
+
+    THEN("an 'e' is only an exponent when digits follow it")
+    {
+      REQUIRE(Parsed("2em", Value));
+      REQUIRE(Value.Number == 2.0f);
+      REQUIRE(Value.Unit == UnitId::Em);
+      REQUIRE(Parsed("2e3", Value));
+      REQUIRE(Value.Number == 2000.0f);
+      REQUIRE(Value.Unit == UnitId::None);
+    }
+
+    THEN("units the table doesn't know are Unknown, and out of range numbers are clamped")
+    {
+      REQUIRE(Parsed("10furlongs", Value));
+      REQUIRE(Value.Unit == UnitId::Unknown);
+      REQUIRE(Parsed("1e99", Value));
+      REQUIRE(Value.Number == std::numeric_limits<float>::max());
+      REQUIRE(Parsed("1e-99", Value));
+      REQUIRE(Value.Number == 0.0f);
+      REQUIRE(Parsed("1e99999999", Value));
+      REQUIRE(Value.Number == std::numeric_limits<float>::max());
+    }
+
+    THEN("numbers round to the nearest float without going through the locale")
+    {
+      REQUIRE(Parsed("0.1", Value));
+      REQUIRE(Value.Number == 0.1f);
+      REQUIRE(Parsed("3.14159", Value));
+      REQUIRE(Value.Number == 3.14159f);
+      REQUIRE(Parsed("-0.000123", Value));
+      REQUIRE(Value.Number == -0.000123f);
+      REQUIRE(Parsed("16777217", Value));
+      REQUIRE(Value.Number == 16777216.0f);
+      REQUIRE(Parsed("123456789012345678901234", Value));
+      REQUIRE(Value.Number == 123456789012345678901234.0f);
+      REQUIRE(Parsed("0.0000000000000000000000000000000000000000000000001e49", Value));
+      REQUIRE(Value.Number == 1.0f);
+    }
+
+    THEN("floats written with nine significant digits read back exactly, whatever their exponent")
+    {
+      const float Samples[] = {
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::min(), std::numeric_limits<float>::denorm_min(),
+        3.0e38f, 1.0e-38f, 1.5e-40f, 6.02214076e23f, 1.17549421e-38f, 7.0e-10f, 123456.789f, 0.3f, -2.5e-30f
+      };
+      for (float Sample : Samples) {
+        char Text[32];
+        std::snprintf(Text, sizeof(Text), "%.9g", ( double )Sample);
+        REQUIRE(Parsed(Text, Value));
+        REQUIRE(Value.Number == Sample);
+      }
+    }
+
+    THEN("text that doesn't start with a number is rejected")
+    {
+      Dimension Untouched;
+      Untouched.Number = 7.0f;
+      REQUIRE(ParseDimension("px", Untouched) == 0);
+      REQUIRE(ParseDimension(".", Untouched) == 0);
+      REQUIRE(ParseDimension("-", Untouched) == 0);
+      REQUIRE(Untouched.Number == 7.0f);
+      REQUIRE(ParseDimension("10 px", Value) == 2);
+    }
+  }
+
+  GIVEN("dimensions in a stylesheet")
+  {
+    Stylesheet Sheet;
+    REQUIRE(Sheet.Parse("p { width: 320px; margin: 1rem 5%; transition: opacity 0.25s; letter-spacing: 2furlongs; }"));
+
+    THEN("each value holds its number and unit")
+    {
+      REQUIRE(Sheet.ValueOf(0).Unit() == UnitId::Px);
+      REQUIRE(Sheet.ValueOf(0).Number() == 320.0f);
+      REQUIRE(Sheet.ValueOf(1).Child(0).Unit() == UnitId::Rem);
+      REQUIRE(Sheet.ValueOf(1).Child(1).Unit() == UnitId::Percent);
+      REQUIRE(Sheet.ValueOf(2).Child(1).Unit() == UnitId::S);
+      REQUIRE(Sheet.ValueOf(2).Child(0).Unit() == UnitId::None);
+      REQUIRE(Sheet.ValueOf(3).Unit() == UnitId::Unknown);
+      REQUIRE(Sheet.ValueOf(3).Name() == "furlongs");
+    }
+  }
+}
+
+SCENARIO("Tokenizing stylesheet text", "[tokenizer]")
+{
+  auto Kinds = [](std::string_view Source) {
+    std::pmr::vector<Token> Tokens;
+    Tokenize(Source, Tokens);
+    std::vector<TokenKind> Result;
+    for (const Token &Each : Tokens)
+      Result.push_back(Each.Kind);
+    return Result;
+  };
+
+  GIVEN("a rule with every common kind of token")
+  {
+    const std::string_view Source = "#nav > a.x[href^='http'] { width: calc(50% - 2.5em); /* gone */ }";
+    std::pmr::vector<Token> Tokens;
+    Tokenize(Source, Tokens);
+
+    THEN("each token has the kind, flags and text the syntax spec gives it")
+    {
+      const std::vector<TokenKind> Expected = {
+        TokenKind::Hash, TokenKind::Whitespace, TokenKind::Delim, TokenKind::Whitespace, TokenKind::Ident,
+        TokenKind::Delim, TokenKind::Ident, TokenKind::LeftBracket, TokenKind::Ident, TokenKind::Delim,
+        TokenKind::Delim, TokenKind::String, TokenKind::RightBracket, TokenKind::Whitespace, TokenKind::LeftBrace,
+        TokenKind::Whitespace, TokenKind::Ident, TokenKind::Colon, TokenKind::Whitespace, TokenKind::Function,
+        TokenKind::Percentage, TokenKind::Whitespace, TokenKind::Delim, TokenKind::Whitespace, TokenKind::Dimension,
+        TokenKind::RightParen, TokenKind::Semicolon, TokenKind::Whitespace, TokenKind::Whitespace, TokenKind::RightBrace,
+        TokenKind::EndOfFile
+      };
+      REQUIRE(Kinds(Source) == Expected);
+      REQUIRE(TextOf(Source, Tokens[0]) == "#nav");
+      REQUIRE(( Tokens[0].Flags & TokenIdHash ) != 0);
+      REQUIRE(TextOf(Source, Tokens[11]) == "'http'");
+      REQUIRE(TextOf(Source, Tokens[19]) == "calc(");
+      REQUIRE(( Tokens[20].Flags & TokenInteger ) != 0);
+      REQUIRE(( Tokens[24].Flags & TokenInteger ) == 0);
+      REQUIRE(TextOf(Source, Tokens[24]) == "2.5em");
+    }
+
+    THEN("comments are dropped without leaving whitespace behind")
+    {
+      REQUIRE(TextOf(Source, Tokens[27]) == " ");
+      REQUIRE(TextOf(Source, Tokens[28]) == " ");
+      const std::vector<TokenKind> Adjacent = {TokenKind::Ident, TokenKind::Ident, TokenKind::EndOfFile};
+      REQUIRE(Kinds("a/**/b") == Adjacent);
+    }
+  }
+
+  GIVEN("tokens that are easy to get wrong")
+  {
+    THEN("numbers, signs and the '-' of identifiers are told apart")
+    {
+      const std::vector<TokenKind> Expected = {
+        TokenKind::Number, TokenKind::Whitespace, TokenKind::Number, TokenKind::Whitespace, TokenKind::Ident,
+        TokenKind::Whitespace, TokenKind::Ident, TokenKind::Whitespace, TokenKind::Delim, TokenKind::Ident, TokenKind::EndOfFile
+      };
+      REQUIRE(Kinds("+.5 -3 -webkit-box --custom +x") == Expected);
+    }
+
+    THEN("url( without quotes is a single url token, and with quotes a function")
+    {
+      const std::vector<TokenKind> Bare = {TokenKind::Url, TokenKind::EndOfFile};
+      const std::vector<TokenKind> Quoted = {TokenKind::Function, TokenKind::String, TokenKind::RightParen, TokenKind::EndOfFile};
+      const std::vector<TokenKind> Bad = {TokenKind::BadUrl, TokenKind::EndOfFile};
+      REQUIRE(Kinds("url( a.png )") == Bare);
+      REQUIRE(Kinds("url(\"a.png\")") == Quoted);
+      REQUIRE(Kinds("url(a b)") == Bad);
+    }
+
+    THEN("a hash whose name isn't an identifier is not an id")
+    {
+      std::pmr::vector<Token> Tokens;
+      Tokenize("#123", Tokens);
+      REQUIRE(Tokens[0].Kind == TokenKind::Hash);
+      REQUIRE(( Tokens[0].Flags & TokenIdHash ) == 0);
+    }
+
+    THEN("HTML comment markers and escapes are recognized")
+    {
+      const std::vector<TokenKind> Markers = {TokenKind::CDO, TokenKind::Whitespace, TokenKind::CDC, TokenKind::EndOfFile};
+      REQUIRE(Kinds("<!-- -->") == Markers);
+
+      std::pmr::vector<Token> Tokens;
+      Tokenize("\\31 0", Tokens);
+      REQUIRE(Tokens[0].Kind == TokenKind::Ident);
+      REQUIRE(( Tokens[0].Flags & TokenEscaped ) != 0);
+    }
+
+    THEN("strings and comments running off the end are flagged")
+    {
+      std::pmr::vector<Token> Tokens;
+      Tokenize("'open", Tokens);
+      REQUIRE(Tokens[0].Kind == TokenKind::String);
+      REQUIRE(( Tokens[0].Flags & TokenUnterminated ) != 0);
+      Tokenize("'line\nbreak'", Tokens);
+      REQUIRE(Tokens[0].Kind == TokenKind::BadString);
+      Tokenize("a /* open", Tokens);
+      REQUIRE(Tokens[2].Kind == TokenKind::Whitespace);
+      REQUIRE(( Tokens[2].Flags & TokenUnterminated ) != 0);
+      REQUIRE(Tokens[3].Kind == TokenKind::EndOfFile);
+    }
+  }
+
+  GIVEN("several rules in one string")
+  {
+    const std::string_view Source = "a { b: '}'; c: { d } } e { }";
+    std::pmr::vector<Token> Tokens;
+    TokenizeRule(Source, Tokens);
+
+    THEN("only the first rule is tokenized, ending with the '}' that closes it")
+    {
+      REQUIRE(Tokens.back().Kind == TokenKind::RightBrace);
+      REQUIRE(Tokens.back().Offset == Source.find(" e") - 1);
+    }
+  }
+
+  GIVEN("a '}' outside any block")
+  {
+    const std::string_view Source = " } a { }";
+    std::pmr::vector<Token> Tokens;
+    TokenizeRule(Source, Tokens);
+
+    THEN("it ends the rule on its own")
+    {
+      REQUIRE(Tokens.size() == 2);
+      REQUIRE(Tokens.back().Kind == TokenKind::RightBrace);
+      REQUIRE(Tokens.back().Offset == 1);
+    }
+  }
+
+  GIVEN("ill-formed rules that only a tokenizer skips correctly")
+  {
+    std::string Source(20000, '}');
+    Source += "\n a:hover { /* it's */ content: '}' } b\\{:x { } c { d: e }";
+
+    Diagnostic Issues[4];
+    BufferDiagnosticSink Sink(Issues);
+    Stylesheet Sheet;
+    REQUIRE(Sheet.Parse(Source, &Sink));
+
+    THEN("each stray '}' is skipped on its own and comments, strings and escapes don't end a skipped rule")
+    {
+      REQUIRE(Sheet.Rules.size() == 1);
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[0].Property) == "d");
+      REQUIRE(Sink[0].Code == DiagnosticCode::InvalidSelector);
+      REQUIRE(Sink[0].Offset == 0);
+    }
+  }
+
+  GIVEN("a rule that fails after naming identifiers the sheet hasn't seen")
+  {
+    Stylesheet Sheet, Clean;
+    REQUIRE(Sheet.Parse("a { color: red }\n.fresh > > b { glow: 1 }\nc { color: blue }"));
+    REQUIRE(Clean.Parse("a { color: red }\nc { color: blue }"));
+
+    THEN("the atoms it interned are dropped with the rest of it")
+    {
+      REQUIRE(Sheet.Rules.size() == 2);
+      REQUIRE(Sheet.Atoms.Size() == Clean.Atoms.Size());
+      REQUIRE(Sheet.Atoms.Find("fresh") == NullAtom);
+      REQUIRE(Sheet.Atoms.Find("c") != NullAtom);
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[1].Property) == "color");
+    }
+
+    WHEN("a later rule names them again")
+    {
+      REQUIRE(Sheet.Parse(".fresh { glow: 2 }"));
+
+      THEN("they are interned as new")
+      {
+        REQUIRE(Sheet.Atoms.Find("fresh") == Sheet.Atoms.Size() - 2);
+        REQUIRE(Sheet.TextOf(Sheet.Atoms.Find("glow")) == "glow");
+      }
+    }
+  }
+
+  GIVEN("stylesheets relying on the tokenizer")
+  {
+    Stylesheet Sheet;
+    REQUIRE(Sheet.Parse("a[href] { --gap: { 1px; }; color: red /* note */ }\n"
+                        "p[title='a;b}'] { margin: 0 }"));
+
+    THEN("custom properties, attribute presence, comments and strings inside rules all parse")
+    {
+      REQUIRE(Sheet.Rules.size() == 2);
+      REQUIRE(Sheet.SimpleSelectors[1].Kind == SimpleSelectorKind::Attribute);
+      REQUIRE(Sheet.TextOf(Sheet.SimpleSelectors[1].Comparison).empty());
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[0].Property) == "--gap");
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[0].Value) == "{ 1px; }");
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[1].Value) == "red");
+      REQUIRE(Sheet.TextOf(Sheet.SimpleSelectors[3].Value) == "a;b}");
+      REQUIRE(Sheet.TextOf(Sheet.Declarations[2].Value) == "0");
+    }
+  }
+}
+
+SCENARIO("Scanning declaration values", "[value-scanner]")
+{
+  const std::string DataUri = "url(\"data:image/png;base64," + std::string(5000, 'Q') + "\")";
+
+  GIVEN("declarations whose values hold ';' and '}' inside strings and brackets")
+  {
+    const std::string Source = "{ background: " + DataUri + "; content: 'a;}b' \"c\\\"d;\"; "
+                               "grid-area: [x;y] (1;2); width: 10px }";
+
+    WHEN("the block is parsed from a stream")
+    {
+      std::stringstream InputString(Source);
+      DeclarationBlock DBlock;
+      REQUIRE(InputString >> DBlock);
+
+      THEN("each value runs to the ';' or '}' that really ends it")
+      {
+        REQUIRE(DBlock.Rules.size() == 4);
+        REQUIRE(DBlock.Rules[0].ValueText == DataUri);
+        REQUIRE(DBlock.Rules[1].ValueText == "'a;}b' \"c\\\"d;\"");
+        REQUIRE(DBlock.Rules[2].ValueText == "[x;y] (1;2)");
+        REQUIRE(DBlock.Rules[3].ValueText == "10px");
+      }
+    }
+
+    WHEN("the block is parsed from a buffer")
+    {
+      BufferCursor Input(Source);
+      DeclarationBlockView DBlock;
+      REQUIRE(Input >> DBlock);
+
+      THEN("the values are the same and the closing brace is consumed")
+      {
+        REQUIRE(DBlock.Rules.size() == 4);
+        REQUIRE(DBlock.Rules[0].ValueText == DataUri);
+        REQUIRE(DBlock.Rules[1].ValueText == "'a;}b' \"c\\\"d;\"");
+        REQUIRE(DBlock.Rules[3].ValueText == "10px");
+        REQUIRE(Input.AtEnd());
+      }
+    }
+  }
+
+  GIVEN("a bad declaration before a '}' inside a string")
+  {
+    std::stringstream InputString("{ color: red; =bad 'x}'; float: left } rest");
+    DeclarationBlock DBlock;
+
+    THEN("recovery skips to the block's own closing brace")
+    {
+      REQUIRE(InputString >> DBlock);
+      REQUIRE(DBlock.Rules.size() == 1);
+      std::string Rest;
+      InputString >> Rest;
+      REQUIRE(Rest == "rest");
+    }
+  }
+
+  GIVEN("ScanValue at every supported instruction set")
+  {
+    const ScannerLevel Detected = DetectScannerLevel();
+    const ScannerLevel Levels[] = { ScannerLevel::Scalar, ScannerLevel::SSE2, ScannerLevel::AVX2 };
+    const std::string Value = DataUri + " 'it''s' [a{b}c]; next";
+    const std::string Unclosed = "'no end; } " + std::string(40, 'z');
+    const std::string BrokenLine = "'one\n; two' ; x";
+
+    THEN("each level stops at the same byte")
+    {
+      for (auto Level : Levels) {
+        if (Level > Detected)
+          continue;
+
+        REQUIRE(SetScannerLevel(Level));
+        REQUIRE(ScanValue(Value.data(), Value.data() + Value.size()) == Value.data() + Value.find("; next"));
+        REQUIRE(ScanValue(Unclosed.data(), Unclosed.data() + Unclosed.size()) == Unclosed.data() + Unclosed.size());
+        REQUIRE(ScanValue(BrokenLine.data(), BrokenLine.data() + BrokenLine.size()) == BrokenLine.data() + 5);
+      }
+
+      REQUIRE(SetScannerLevel(Detected));
+    }
+  }
+}
@@ -0,0 +1,395 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Tokenizer.h>
+#include <Scanner.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  namespace
+  {
+
+    __forceinline bool IsNewline(int c) { return c == '\n' || c == '\r' || c == '\f'; }
+    __forceinline bool IsHexByte(int c) { return IsDigitByte(c) || ( unsigned )( ( c | 0x20 ) - 'a' ) <= 5u; }
+
+    /* c is -1 past the end */
+    __forceinline bool IsValidEscape(int First, int Second) { return First == '\\' && Second != -1 && !IsNewline(Second); }
+
+    __forceinline bool StartsIdentifier(int First, int Second, int Third)
+    {
+      if (First == '-')
+        return ( Second != -1 && IsNameStartByte(Second) ) || Second == '-' || IsValidEscape(Second, Third);
+      if (First == '\\')
+        return IsValidEscape(First, Second);
+      return First != -1 && IsNameStartByte(First);
+    }
+
+    __forceinline bool StartsNumber(int First, int Second, int Third)
+    {
+      if (First == '+' || First == '-')
+        return IsDigitByte(Second) || ( Second == '.' && IsDigitByte(Third) );
+      if (First == '.')
+        return IsDigitByte(Second);
+      return IsDigitByte(First);
+    }
+
+    __forceinline bool IsNonPrintable(int c) { return ( c >= 0 && c <= 8 ) || c == 0x0B || ( c >= 0x0E && c <= 0x1F ) || c == 0x7F; }
+
+  }
+
+  Token Tokenizer::Make(TokenKind Kind, const char *Start, std::uint16_t Flags) const
+  {
+    Token Made;
+    Made.Kind = Kind;
+    Made.Flags = Flags;
+    Made.Offset = ( std::uint32_t )( Start - Begin );
+    Made.Length = ( std::uint32_t )( Pos - Start );
+    return Made;
+  }
+
+  Token Tokenizer::Next()
+  {
+    /* Comments are dropped, unless one runs off the end */
+    while (At(0) == '/' && At(1) == '*') {
+      const char *Start = Pos;
+      const std::string_view Rest(Pos + 2, ( std::size_t )( End - Pos - 2 ));
+      const std::size_t Close = Rest.find("*/");
+      if (Close == std::string_view::npos) {
+        Pos = End;
+        return Make(TokenKind::Whitespace, Start, TokenUnterminated);
+      }
+      Pos += Close + 4;
+    }
+
+    const char *Start = Pos;
+    const int c = At(0);
+
+    if (c == -1)
+      return Make(TokenKind::EndOfFile, Start);
+
+    if (IsWhitespaceByte(c)) {
+      Pos = ScanWhitespace(Pos + 1, End);
+      return Make(TokenKind::Whitespace, Start);
+    }
+
+    if (StartsNumber(c, At(1), At(2)))
+      return ConsumeNumeric(Start);
+
+    /* "-->" would otherwise start an identifier */
+    if (c == '-' && At(1) == '-' && At(2) == '>') {
+      Pos += 3;
+      return Make(TokenKind::CDC, Start);
+    }
+
+    if (StartsIdentifier(c, At(1), At(2)))
+      return ConsumeIdentLike(Start);
+
+    switch (c)
+    {
+      case '"':
+      case '\'':
+        return ConsumeString(Start);
+
+      case '#':
+        if (( At(1) != -1 && IsNameByte(At(1)) ) || IsValidEscape(At(1), At(2))) {
+          const std::uint16_t Flags = StartsIdentifier(At(1), At(2), At(3)) ? TokenIdHash : 0;
+          ++Pos;
+          const bool Escaped = ConsumeName();
+          return Make(TokenKind::Hash, Start, ( std::uint16_t )( Flags | ( Escaped ? TokenEscaped : 0 ) ));
+        }
+        break;
+
+      case '<':
+        if (At(1) == '!' && At(2) == '-' && At(3) == '-') {
+          Pos += 4;
+          return Make(TokenKind::CDO, Start);
+        }
+        break;
+
+      case '@':
+        if (StartsIdentifier(At(1), At(2), At(3))) {
+          ++Pos;
+          const bool Escaped = ConsumeName();
+          return Make(TokenKind::AtKeyword, Start, Escaped ? TokenEscaped : 0);
+        }
+        break;
+
+      case '(': ++Pos; return Make(TokenKind::LeftParen, Start);
+      case ')': ++Pos; return Make(TokenKind::RightParen, Start);
+      case '[': ++Pos; return Make(TokenKind::LeftBracket, Start);
+      case ']': ++Pos; return Make(TokenKind::RightBracket, Start);
+      case '{': ++Pos; return Make(TokenKind::LeftBrace, Start);
+      case '}': ++Pos; return Make(TokenKind::RightBrace, Start);
+      case ',': ++Pos; return Make(TokenKind::Comma, Start);
+      case ':': ++Pos; return Make(TokenKind::Colon, Start);
+      case ';': ++Pos; return Make(TokenKind::Semicolon, Start);
+
+      default:
+        break;
+    }
+
+    ++Pos;
+    return Make(TokenKind::Delim, Start);
+  }
+
+  Token Tokenizer::ConsumeNumeric(const char *Start)
+  {
+    std::uint16_t Flags = TokenInteger;
+
+    if (At(0) == '+' || At(0) == '-')
+      ++Pos;
+    while (IsDigitByte(At(0)))
+      ++Pos;
+    if (At(0) == '.' && IsDigitByte(At(1))) {
+      Flags = 0;
+      Pos += 2;
+      while (IsDigitByte(At(0)))
+        ++Pos;
+    }
+    if (( At(0) == 'e' || At(0) == 'E' ) && ( IsDigitByte(At(1)) || ( ( At(1) == '+' || At(1) == '-' ) && IsDigitByte(At(2)) ) )) {
+      Flags = 0;
+      Pos += 2;
+      while (IsDigitByte(At(0)))
+        ++Pos;
+    }
+
+    if (StartsIdentifier(At(0), At(1), At(2))) {
+      if (ConsumeName())
+        Flags |= TokenEscaped;
+      return Make(TokenKind::Dimension, Start, Flags);
+    }
+
+    if (At(0) == '%') {
+      ++Pos;
+      return Make(TokenKind::Percentage, Start, Flags);
+    }
+
+    return Make(TokenKind::Number, Start, Flags);
+  }
+
+  Token Tokenizer::ConsumeIdentLike(const char *Start)
+  {
+    const bool Escaped = ConsumeName();
+    const std::uint16_t Flags = Escaped ? TokenEscaped : 0;
+
+    if (At(0) != '(')
+      return Make(TokenKind::Ident, Start, Flags);
+
+    const bool IsUrl = Pos - Start == 3 && ( Start[0] | 0x20 ) == 'u' && ( Start[1] | 0x20 ) == 'r' && ( Start[2] | 0x20 ) == 'l';
+    ++Pos;
+
+    if (IsUrl) {
+      /* url( followed by a quote is an ordinary function holding a string */
+      const char *AfterSpace = Pos;
+      while (AfterSpace != End && IsWhitespaceByte(( unsigned char )*AfterSpace))
+        ++AfterSpace;
+      if (AfterSpace == End || ( *AfterSpace != '"' && *AfterSpace != '\'' ))
+        return ConsumeUrl(Start);
+    }
+
+    return Make(TokenKind::Function, Start, Flags);
+  }
+
+  Token Tokenizer::ConsumeString(const char *Start)
+  {
+    const int Quote = At(0);
+    std::uint16_t Flags = 0;
+    ++Pos;
+
+    while (true) {
+      const int c = At(0);
+
+      if (c == -1)
+        return Make(TokenKind::String, Start, ( std::uint16_t )( Flags | TokenUnterminated ));
+
+      if (c == Quote) {
+        ++Pos;
+        return Make(TokenKind::String, Start, Flags);
+      }
+
+      /* The newline isn't part of the bad string */
+      if (IsNewline(c))
+        return Make(TokenKind::BadString, Start, Flags);
+
+      if (c == '\\') {
+        Flags |= TokenEscaped;
+        if (At(1) == -1) {
+          ++Pos;
+          continue;
+        }
+        Pos += ( At(1) == '\r' && At(2) == '\n' ) ? 3 : 2;
+        continue;
+      }
+
+      ++Pos;
+    }
+  }
+
+  /* Pos is just past "url(" */
+  Token Tokenizer::ConsumeUrl(const char *Start)
+  {
+    std::uint16_t Flags = 0;
+    Pos = ScanWhitespace(Pos, End);
+
+    while (true) {
+      const int c = At(0);
+
+      if (c == -1)
+        return Make(TokenKind::Url, Start, ( std::uint16_t )( Flags | TokenUnterminated ));
+
+      if (c == ')') {
+        ++Pos;
+        return Make(TokenKind::Url, Start, Flags);
+      }
+
+      if (IsWhitespaceByte(c)) {
+        Pos = ScanWhitespace(Pos, End);
+        if (At(0) == ')' || At(0) == -1)
+          continue;
+        return ConsumeBadUrl(Start);
+      }
+
+      if (c == '"' || c == '\'' || c == '(' || IsNonPrintable(c))
+        return ConsumeBadUrl(Start);
+
+      if (c == '\\') {
+        if (!IsValidEscape(c, At(1)))
+          return ConsumeBadUrl(Start);
+        Flags |= TokenEscaped;
+        Pos += 2;
+        continue;
+      }
+
+      ++Pos;
+    }
+  }
+
+  /* Skips the rest of a broken url so it can't start anything */
+  Token Tokenizer::ConsumeBadUrl(const char *Start)
+  {
+    while (At(0) != -1 && At(0) != ')')
+      Pos += IsValidEscape(At(0), At(1)) ? 2 : 1;
+
+    if (At(0) == ')')
+      ++Pos;
+
+    return Make(TokenKind::BadUrl, Start);
+  }
+
+  /* Returns true if the name had escapes in it */
+  bool Tokenizer::ConsumeName()
+  {
+    bool Escaped = false;
+
+    while (true) {
+      const int c = At(0);
+
+      if (c != -1 && IsNameByte(c)) {
+        ++Pos;
+      }
+      else if (IsValidEscape(c, At(1))) {
+        /* A hex escape takes up to six digits and one whitespace after them */
+        Escaped = true;
+        Pos += 2;
+        if (IsHexByte(( unsigned char )Pos[-1])) {
+          for (int Digits = 1; Digits < 6 && IsHexByte(At(0)); ++Digits)
+            ++Pos;
+          if (At(0) != -1 && IsWhitespaceByte(At(0)))
+            Pos += ( At(0) == '\r' && At(1) == '\n' ) ? 2 : 1;
+        }
+      }
+      else {
+        return Escaped;
+      }
+    }
+  }
+
+  void Tokenize(std::string_view Source, std::pmr::vector<Token> &Tokens)
+  {
+    Tokens.clear();
+
+    Tokenizer Input(Source);
+    while (true) {
+      Tokens.push_back(Input.Next());
+      if (Tokens.back().Kind == TokenKind::EndOfFile)
+        return;
+    }
+  }
+
+  void TokenizeRule(std::string_view Source, std::pmr::vector<Token> &Tokens)
+  {
+    Tokens.clear();
+
+    Tokenizer Input(Source);
+    int Depth = 0;
+
+    while (true) {
+      const Token Next = Input.Next();
+      Tokens.push_back(Next);
+
+      switch (Next.Kind)
+      {
+        case TokenKind::EndOfFile:
+          return;
+
+        case TokenKind::LeftBrace:
+          ++Depth;
+          break;
+
+        /* A stray '}' outside any block is a rule of its own, so whoever skips it skips just that */
+        case TokenKind::RightBrace:
+          if (Depth == 0 || --Depth == 0)
+            return;
+          break;
+
+        case TokenKind::Semicolon:
+          if (Depth == 0)
+            return;
+          break;
+
+        default:
+          break;
+      }
+    }
+  }
+
+}
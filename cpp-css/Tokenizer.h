@@ -0,0 +1,158 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  Tokenizer
+//   - Turns CSS text into the tokens of CSS Syntax Level 3
+//     (section 4) in one pass, so the grammar above it
+//     only ever looks at whole tokens and never skips
+//     whitespace, comments or strings by hand
+//   - A Token is 12 bytes: its kind, a flag word, and
+//     where its text is in the source.  Nothing is copied
+//     or unescaped; a token's text is always
+//     Source.substr(Offset, Length)
+//   - Comments produce no token.  A comment that is never
+//     closed becomes a Whitespace token flagged
+//     Unterminated, so whoever skips it can report it
+//   - Escapes are recognized (so they never end a token
+//     early) but kept as written, and the token is
+//     flagged Escaped
+//   - Tokenize() fills a caller's vector, which keeps its
+//     capacity between calls.  TokenizeRule() stops at the
+//     end of the first rule, so a parser only tokenizes
+//     what it is about to read
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  enum class TokenKind : std::uint8_t
+  {
+    Ident,
+    Function,      // the name and its '('
+    AtKeyword,
+    Hash,
+    String,        // the quotes included
+    BadString,
+    Url,           // an unquoted url(...), whole
+    BadUrl,
+    Delim,         // one character
+    Number,
+    Percentage,
+    Dimension,
+    Whitespace,
+    CDO,
+    CDC,
+    Colon,
+    Semicolon,
+    Comma,
+    LeftBracket,
+    RightBracket,
+    LeftParen,
+    RightParen,
+    LeftBrace,
+    RightBrace,
+    EndOfFile
+  };
+
+  enum TokenFlags : std::uint16_t
+  {
+    TokenIdHash       = 1 << 0,   // a Hash whose name would also be an identifier
+    TokenInteger      = 1 << 1,   // a number without a fraction or exponent
+    TokenEscaped      = 1 << 2,   // the text contains escapes
+    TokenUnterminated = 1 << 3    // a string, url or comment ran to the end of the input
+  };
+
+  struct Token
+  {
+    TokenKind     Kind = TokenKind::EndOfFile;
+    std::uint16_t Flags = 0;
+    std::uint32_t Offset = 0;
+    std::uint32_t Length = 0;
+  };
+
+  class Tokenizer
+  {
+  public:
+
+    explicit Tokenizer(std::string_view Source) : Begin(Source.data()), Pos(Source.data()), End(Source.data() + Source.size()) { }
+
+    /* The next token; EndOfFile once the input is used up */
+    Token Next();
+
+    std::size_t Offset() const { return ( std::size_t )( Pos - Begin ); }
+
+  private:
+
+    Token Make(TokenKind Kind, const char *Start, std::uint16_t Flags = 0) const;
+
+    Token ConsumeNumeric(const char *Start);
+    Token ConsumeIdentLike(const char *Start);
+    Token ConsumeString(const char *Start);
+    Token ConsumeUrl(const char *Start);
+    Token ConsumeBadUrl(const char *Start);
+    bool ConsumeName();
+
+    int At(std::size_t Ahead) const { return Pos + Ahead < End ? ( unsigned char )Pos[Ahead] : -1; }
+
+    const char *Begin, *Pos, *End;
+  };
+
+  /* Every token in Source, ending with EndOfFile */
+  void Tokenize(std::string_view Source, std::pmr::vector<Token> &Tokens);
+
+  /* The tokens of the first rule in Source: up to and including the '}' that closes its
+     block, or a ';' or '}' outside any block, or else an EndOfFile */
+  void TokenizeRule(std::string_view Source, std::pmr::vector<Token> &Tokens);
+
+  inline std::string_view TextOf(std::string_view Source, const Token &Of) { return Source.substr(Of.Offset, Of.Length); }
+
+}
@@ -0,0 +1,176 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Units.h>
+#include <Scanner.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+/* Floating-point from_chars (VS2019 16.4, libstdc++ 11) defines __cpp_lib_to_chars.  The
+   v141 library only converts integers, and builds with it use the conversion below */
+#if defined(__cpp_lib_to_chars)
+#define CSS_FLOAT_FROM_CHARS
+#endif
+
+namespace css
+{
+
+  namespace
+  {
+
+    /* Every power of ten up to 1e22 is exact in a double */
+    constexpr double ExactPowers[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    __forceinline double PowerOfTen(int Exponent)
+    {
+      return Exponent <= 22 ? ExactPowers[Exponent] : std::pow(10.0, Exponent);
+    }
+
+    /* Enough digits for a float; the rest only move the decimal point */
+    constexpr std::uint64_t MantissaLimit = 100000000000000000ull;
+
+  }
+
+  const char* ScanNumber(const char *First, const char *Last, float &Number)
+  {
+    const char *Pos = First;
+
+    const bool Negative = Pos != Last && *Pos == '-';
+    if (Pos != Last && ( *Pos == '+' || *Pos == '-' ))
+      ++Pos;
+
+    std::uint64_t Mantissa = 0;
+    int Scale = 0;
+
+    const char *Digits = Pos;
+    for (; Pos != Last && IsDigitByte(( unsigned char )*Pos); ++Pos) {
+      if (Mantissa < MantissaLimit)
+        Mantissa = Mantissa * 10 + ( unsigned )( *Pos - '0' );
+      else
+        ++Scale;
+    }
+    if (Pos != Last && *Pos == '.' && Pos + 1 != Last && IsDigitByte(( unsigned char )Pos[1])) {
+      for (++Pos; Pos != Last && IsDigitByte(( unsigned char )*Pos); ++Pos) {
+        if (Mantissa < MantissaLimit) {
+          Mantissa = Mantissa * 10 + ( unsigned )( *Pos - '0' );
+          --Scale;
+        }
+      }
+    }
+
+    if (Pos == Digits)
+      return First;
+
+    /* Only an exponent if digits follow, so "2em" is 2 with unit "em".  Anything past
+       four digits is out of a float's range either way */
+    if (Pos != Last && ( *Pos == 'e' || *Pos == 'E' )) {
+      const char *Exponent = Pos + 1;
+      const bool Shrinks = Exponent != Last && *Exponent == '-';
+      if (Exponent != Last && ( *Exponent == '+' || *Exponent == '-' ))
+        ++Exponent;
+      if (Exponent != Last && IsDigitByte(( unsigned char )*Exponent)) {
+        int Value = 0;
+        for (Pos = Exponent; Pos != Last && IsDigitByte(( unsigned char )*Pos); ++Pos)
+          Value = Value < 10000 ? Value * 10 + ( *Pos - '0' ) : Value;
+        Scale += Shrinks ? -Value : Value;
+      }
+    }
+
+#ifdef CSS_FLOAT_FROM_CHARS
+    /* Correctly rounded.  Only the text scanned above is given to it, since it would also take
+       "5." or an exponent without digits; out of range is left to the clamping below */
+    float Parsed = 0.0f;
+    if (std::from_chars(Digits, Pos, Parsed).ec == std::errc()) {
+      Number = Negative ? -Parsed : Parsed;
+      return Pos;
+    }
+#endif
+
+    /* Converting by hand rather than with strtod keeps this locale free.  The double has
+       far more precision than the float it is rounded to */
+    double Converted = ( double )Mantissa;
+    if (Mantissa != 0)
+      Converted = Scale < 0 ? Converted / PowerOfTen(-Scale) : Converted * PowerOfTen(Scale);
+
+    /* Out of range is clamped; too small is already 0 */
+    if (Converted > std::numeric_limits<float>::max())
+      Converted = std::numeric_limits<float>::max();
+
+    Number = ( float )( Negative ? -Converted : Converted );
+    return Pos;
+  }
+
+  std::size_t ParseDimension(std::string_view Text, Dimension &Value)
+  {
+    const char *First = Text.data(), *End = First + Text.size();
+
+    float Number = 0.0f;
+    const char *Pos = ScanNumber(First, End, Number);
+    if (Pos == First)
+      return 0;
+
+    UnitId Unit = UnitId::None;
+    if (Pos != End && *Pos == '%') {
+      Unit = UnitId::Percent;
+      ++Pos;
+    }
+    else if (Pos != End && ( IsNameStartByte(( unsigned char )*Pos) ||
+             ( *Pos == '-' && Pos + 1 != End && ( IsNameStartByte(( unsigned char )Pos[1]) || Pos[1] == '-' ) ) )) {
+      const char *Name = Pos;
+      while (Pos != End && IsNameByte(( unsigned char )*Pos))
+        ++Pos;
+      Unit = LookupUnit(std::string_view(Name, ( std::size_t )( Pos - Name )));
+    }
+
+    Value.Number = Number;
+    Value.Unit = Unit;
+    return ( std::size_t )( Pos - First );
+  }
+
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+////////////////////////////////////////////////////////////
+//  Units
+//   - A dense id for every unit a CSS dimension can have,
+//     so a length is a float and a byte, not a float and
+//     a string
+//   - Every unit name is at most four characters, so a
+//     name is folded to lower case and packed into one
+//     32-bit key.  Looking a unit up compares that key
+//     against a constexpr table; no string compares
+//   - Numbers are converted with std::from_chars where
+//     the library converts floats, and by hand from their
+//     digits where it doesn't (v141): no locale, no
+//     allocation and no terminating copy either way
+//   - To add a unit, add it to CSS_UNITS
+//
+////////////////////////////////////////////////////////////
+
+#define CSS_UNITS(X) \
+  X(Px,   "px") \
+  X(Em,   "em") \
+  X(Rem,  "rem") \
+  X(Ex,   "ex") \
+  X(Ch,   "ch") \
+  X(Vw,   "vw") \
+  X(Vh,   "vh") \
+  X(Vmin, "vmin") \
+  X(Vmax, "vmax") \
+  X(Cm,   "cm") \
+  X(Mm,   "mm") \
+  X(Q,    "q") \
+  X(In,   "in") \
+  X(Pt,   "pt") \
+  X(Pc,   "pc") \
+  X(Deg,  "deg") \
+  X(Grad, "grad") \
+  X(Rad,  "rad") \
+  X(Turn, "turn") \
+  X(S,    "s") \
+  X(Ms,   "ms") \
+  X(Hz,   "hz") \
+  X(KHz,  "khz") \
+  X(Dpi,  "dpi") \
+  X(Dpcm, "dpcm") \
+  X(Dppx, "dppx") \
+  X(X,    "x") \
+  X(Fr,   "fr")
+
+namespace css
+{
+
+  enum class UnitId : std::uint8_t
+  {
+    None,      // a plain number
+    Percent,
+    Unknown,   // a unit this table doesn't know; the text still has it
+#define CSS_UNIT_ENUM(ID, NAME) ID,
+    CSS_UNITS(CSS_UNIT_ENUM)
+#undef CSS_UNIT_ENUM
+    Count
+  };
+
+  namespace Detail
+  {
+
+    /* Indexed by UnitId */
+    constexpr std::string_view UnitNames[] = {
+      "",
+      "%",
+      "",
+#define CSS_UNIT_NAME(ID, NAME) NAME,
+      CSS_UNITS(CSS_UNIT_NAME)
+#undef CSS_UNIT_NAME
+    };
+
+    constexpr std::size_t FirstNamedUnit = ( std::size_t )UnitId::Unknown + 1;
+
+    /* Up to four characters, folded to lower case, first character in the low byte.
+       0 for anything longer */
+    constexpr std::uint32_t UnitKey(std::string_view Name)
+    {
+      if (Name.empty() || Name.size() > 4)
+        return 0;
+
+      std::uint32_t Key = 0;
+      for (std::size_t i = 0; i < Name.size(); ++i) {
+        const char c = Name[i];
+        Key |= ( std::uint32_t )( unsigned char )( ( c >= 'A' && c <= 'Z' ) ? ( c | 0x20 ) : c ) << ( 8 * i );
+      }
+      return Key;
+    }
+
+    /* Indexed by UnitId, 0 for None, Percent and Unknown */
+    constexpr std::array<std::uint32_t, ( std::size_t )UnitId::Count> BuildUnitKeys()
+    {
+      std::array<std::uint32_t, ( std::size_t )UnitId::Count> Keys = { };
+      for (std::size_t u = FirstNamedUnit; u < ( std::size_t )UnitId::Count; ++u)
+        Keys[u] = UnitKey(UnitNames[u]);
+      return Keys;
+    }
+
+    constexpr std::array<std::uint32_t, ( std::size_t )UnitId::Count> UnitKeys = BuildUnitKeys();
+
+  }
+
+  /* Unknown for names that aren't units (or are empty) */
+  constexpr UnitId LookupUnit(std::string_view Name)
+  {
+    const std::uint32_t Key = Detail::UnitKey(Name);
+    if (Key != 0) {
+      for (std::size_t u = Detail::FirstNamedUnit; u < ( std::size_t )UnitId::Count; ++u)
+        if (Detail::UnitKeys[u] == Key)
+          return ( UnitId )u;
+    }
+    return UnitId::Unknown;
+  }
+
+  /* The unit's name in lower case; empty for None and Unknown */
+  constexpr std::string_view UnitName(UnitId Id)
+  {
+    return ( std::size_t )Id < ( std::size_t )UnitId::Count ? Detail::UnitNames[( std::size_t )Id] : std::string_view();
+  }
+
+  struct Dimension
+  {
+    float  Number = 0;
+    UnitId Unit = UnitId::None;
+  };
+
+  /* Reads a CSS number (sign, digits, fraction, exponent) at First.  Returns where it
+     ended, or First if there isn't one */
+  const char* ScanNumber(const char *First, const char *Last, float &Number);
+
+  /* A number, optionally followed by '%' or a unit, at the start of Text.  Returns how
+     many characters it took, or 0 (and leaves Value alone) if Text doesn't start with one */
+  std::size_t ParseDimension(std::string_view Text, Dimension &Value);
+
+}
@@ -0,0 +1,377 @@
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Values.h>
+#include <Stylesheet.h>
+#include <Scanner.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  /************************************************************************/
+  /* Parsing                                                              */
+  /************************************************************************/
+  ValueParser::ValueParser(std::pmr::vector<ValueRecord> &Values, AtomTable &Atoms)
+    : Values(Values), Atoms(Atoms)
+  {
+  }
+
+  std::uint32_t ValueParser::Parse(const Token *First, const Token *Last, std::string_view Text, TextRef Stored)
+  {
+    const auto Root = ( std::uint32_t )Values.size();
+
+    Source = Text;
+    Pos = First;
+    End = Last;
+    Shift = First != Last ? Stored.Offset - First->Offset : 0;
+
+    SkipWhitespace();
+    if (Pos == End) {
+      ValueRecord Empty;
+      Empty.Text = Stored;
+      Values.push_back(Empty);
+      return Root;
+    }
+
+    const std::uint32_t Start = Pos->Offset;
+    std::size_t Count = 0;
+    bool Commas = false;
+
+    if (!ParseItems(Count, Commas) || Pos != End) {
+      Values.resize(Root);
+
+      ValueRecord Raw;
+      Raw.Kind = ValueKind::Raw;
+      Raw.Text = Stored;
+      Values.push_back(Raw);
+      return Root;
+    }
+
+    if (Commas)
+      WrapList(Root, Count, CommaSeparated, Start, End[-1].Offset + End[-1].Length);
+
+    return Root;
+  }
+
+  bool ValueParser::ParseItems(std::size_t &Count, bool &Commas)
+  {
+    Count = 0;
+    Commas = false;
+
+    while (true) {
+      if (!ParseItem())
+        return false;
+
+      ++Count;
+      if (Pos == End || Pos->Kind != TokenKind::Comma)
+        return true;
+
+      Commas = true;
+      ++Pos;
+      SkipWhitespace();
+    }
+  }
+
+  bool ValueParser::ParseItem()
+  {
+    const std::size_t First = Values.size();
+    const std::uint32_t Start = Pos != End ? Pos->Offset : 0;
+    std::uint32_t Stop = Start;
+    std::size_t Parts = 0;
+
+    while (Pos != End && Pos->Kind != TokenKind::Comma && Pos->Kind != TokenKind::RightParen) {
+      if (!ParsePart())
+        return false;
+
+      ++Parts;
+      Stop = Pos[-1].Offset + Pos[-1].Length;
+      SkipWhitespace();
+    }
+
+    if (Parts == 0)
+      return false;
+
+    if (Parts > 1)
+      WrapList(First, Parts, 0, Start, Stop);
+
+    return true;
+  }
+
+  bool ValueParser::ParsePart()
+  {
+    const Token &Part = *Pos;
+    const std::string_view Text = TextOf(Part);
+    std::uint32_t Color = 0;
+
+    switch (Part.Kind)
+    {
+      case TokenKind::Ident:
+        if (LookupNamedColor(Text, Color))
+          Push(ValueKind::Color, Color, Part);
+        else
+          Push(ValueKind::Keyword, InternFolded(Text), Part);
+        ++Pos;
+        return true;
+
+      case TokenKind::Hash:
+        if (!DecodeHexColor(Text.substr(1), Color))
+          return false;
+        Push(ValueKind::Color, Color, Part);
+        ++Pos;
+        return true;
+
+      case TokenKind::Number:
+      case TokenKind::Percentage:
+      case TokenKind::Dimension:
+      {
+        Dimension Parsed;
+        ParseDimension(Text, Parsed);
+
+        const ValueKind Kind = Parsed.Unit == UnitId::None ? ValueKind::Number : Parsed.Unit == UnitId::Percent ? ValueKind::Percentage : ValueKind::Dimension;
+        Push(Kind, ( std::uint32_t )Parsed.Unit, Part);
+        Values.back().Number = Parsed.Number;
+        ++Pos;
+        return true;
+      }
+
+      /* Only the text between the quotes; escapes are kept as written */
+      case TokenKind::String:
+        if (Part.Flags & TokenUnterminated)
+          return false;
+        Push(ValueKind::String, 0, Part);
+        Values.back().Text = RefTo(Part.Offset + 1, Part.Offset + Part.Length - 1);
+        ++Pos;
+        return true;
+
+      /* An unquoted url(...) is stored like url("..."): a function holding one string */
+      case TokenKind::Url:
+      {
+        if (Part.Flags & TokenUnterminated)
+          return false;
+
+        std::uint32_t Start = Part.Offset + 4, Stop = Part.Offset + Part.Length - 1;
+        while (Start < Stop && IsWhitespaceByte(( unsigned char )Source[Start]))
+          ++Start;
+        while (Stop > Start && IsWhitespaceByte(( unsigned char )Source[Stop - 1]))
+          --Stop;
+
+        Push(ValueKind::Function, InternFolded("url"), Part);
+        Values.back().Count = 1;
+        Values.back().Size = 2;
+        Push(ValueKind::String, 0, Part);
+        Values.back().Text = RefTo(Start, Stop);
+        ++Pos;
+        return true;
+      }
+
+      case TokenKind::Function:
+        return ParseFunction();
+
+      case TokenKind::Delim:
+      case TokenKind::Colon:
+        Push(ValueKind::Delimiter, ( unsigned char )Text[0], Part);
+        ++Pos;
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+  bool ValueParser::ParseFunction()
+  {
+    const Token &Name = *Pos;
+    const std::string_view Text = TextOf(Name);
+
+    /* rgb() and hsl() go to the color parser, given only the text the value's tokens cover */
+    std::uint32_t Color = 0;
+    const std::uint32_t Limit = End[-1].Offset + End[-1].Length - Name.Offset;
+    if (const std::size_t Length = ParseColor(Source.substr(Name.Offset, Limit), Color)) {
+      const std::uint32_t Stop = Name.Offset + ( std::uint32_t )Length;
+      Push(ValueKind::Color, Color, Name);
+      Values.back().Text = RefTo(Name.Offset, Stop);
+      while (Pos != End && Pos->Offset < Stop)
+        ++Pos;
+      return true;
+    }
+
+    const std::size_t Function = Values.size();
+    Push(ValueKind::Function, InternFolded(Text.substr(0, Text.size() - 1)), Name);
+    ++Pos;
+    SkipWhitespace();
+
+    std::size_t Count = 0;
+    bool Commas = false;
+    if (Pos != End && Pos->Kind != TokenKind::RightParen && !ParseItems(Count, Commas))
+      return false;
+
+    if (Pos == End || Pos->Kind != TokenKind::RightParen)
+      return false;
+
+    ValueRecord &Finished = Values[Function];
+    Finished.Count = ( std::uint16_t )Count;
+    Finished.Size = ( std::uint32_t )( Values.size() - Function );
+    Finished.Text = RefTo(Name.Offset, Pos->Offset + 1);
+    ++Pos;
+    return true;
+  }
+
+  void ValueParser::WrapList(std::size_t First, std::size_t Count, std::uint8_t Flags, std::uint32_t Start, std::uint32_t Stop)
+  {
+    ValueRecord List;
+    List.Kind = ValueKind::List;
+    List.Flags = Flags;
+    List.Count = ( std::uint16_t )Count;
+    List.Size = ( std::uint32_t )( Values.size() - First + 1 );
+    List.Text = RefTo(Start, Stop);
+    Values.insert(Values.begin() + First, List);
+  }
+
+  void ValueParser::Push(ValueKind Kind, std::uint32_t Data, const Token &From)
+  {
+    ValueRecord Value;
+    Value.Kind = Kind;
+    Value.Data = Data;
+    Value.Text = RefTo(From.Offset, From.Offset + From.Length);
+    Values.push_back(Value);
+  }
+
+  Atom ValueParser::InternFolded(std::string_view Name)
+  {
+    Folded.assign(Name.data(), Name.size());
+    for (char &c : Folded)
+      if (c >= 'A' && c <= 'Z')
+        c = ( char )( c | 0x20 );
+    return Atoms.Intern(Folded);
+  }
+
+  /* Empty text stays {0, 0}, as Stylesheet::StoreText keeps it */
+  TextRef ValueParser::RefTo(std::uint32_t Start, std::uint32_t Stop) const
+  {
+    TextRef Ref;
+    if (Start == Stop)
+      return Ref;
+
+    Ref.Offset = Start + Shift;
+    Ref.Length = Stop - Start;
+    return Ref;
+  }
+
+  void ValueParser::SkipWhitespace()
+  {
+    while (Pos != End && Pos->Kind == TokenKind::Whitespace)
+      ++Pos;
+  }
+
+  /************************************************************************/
+  /* Views                                                                */
+  /************************************************************************/
+  const ValueRecord& ValueView::Record() const
+  {
+    return Sheet->Values[Index];
+  }
+
+  ValueKind ValueView::Kind() const
+  {
+    return Record().Kind;
+  }
+
+  float ValueView::Number() const
+  {
+    return Record().Number;
+  }
+
+  std::uint32_t ValueView::Color() const
+  {
+    return Record().Kind == ValueKind::Color ? Record().Data : 0;
+  }
+
+  std::string_view ValueView::Name() const
+  {
+    const ValueRecord &Value = Record();
+    if (Value.Kind == ValueKind::Keyword || Value.Kind == ValueKind::Function)
+      return Sheet->Atoms.TextOf(Value.Data);
+
+    if (Value.Kind == ValueKind::Dimension) {
+      if (( UnitId )Value.Data != UnitId::Unknown)
+        return UnitName(( UnitId )Value.Data);
+
+      /* Units the table doesn't know are only in the text, after the number */
+      const std::string_view Source = Text();
+      float Number = 0.0f;
+      const char *Unit = ScanNumber(Source.data(), Source.data() + Source.size(), Number);
+      return Source.substr(( std::size_t )( Unit - Source.data() ));
+    }
+
+    return { };
+  }
+
+  UnitId ValueView::Unit() const
+  {
+    const ValueRecord &Value = Record();
+    return ( Value.Kind == ValueKind::Number || Value.Kind == ValueKind::Percentage || Value.Kind == ValueKind::Dimension ) ? ( UnitId )Value.Data : UnitId::None;
+  }
+
+  std::string_view ValueView::Text() const
+  {
+    return Sheet->TextOf(Record().Text);
+  }
+
+  std::size_t ValueView::Count() const
+  {
+    return Record().Count;
+  }
+
+  /* Walks over the earlier children's subtrees, so this is linear in Position */
+  ValueView ValueView::Child(std::size_t Position) const
+  {
+    std::uint32_t Found = Index + 1;
+    for (std::size_t i = 0; i < Position; ++i)
+      Found += Sheet->Values[Found].Size;
+    return ValueView(*Sheet, Found);
+  }
+
+  bool ValueView::IsComma() const
+  {
+    return ( Record().Flags & CommaSeparated ) != 0;
+  }
+
+}
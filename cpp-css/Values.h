@@ -0,0 +1,206 @@
+#pragma once
+
+////////////////////////////////////////////////////////////
+//
+// MIT License
+//
+// Copyright(c) 2017 Kurt Slagle - kurt_slagle@yahoo.com
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// The origin of this software must not be misrepresented; you must not claim
+// that you wrote the original software.If you use this software in a product,
+// an acknowledgment of the software used is required.
+//
+////////////////////////////////////////////////////////////
+
+
+////////////////////////////////////////////////////////////
+// Internal Headers
+////////////////////////////////////////////////////////////
+#include <Atoms.h>
+#include <Colors.h>
+#include <Units.h>
+#include <Tokenizer.h>
+
+////////////////////////////////////////////////////////////
+// Dependency Headers
+////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////
+// Standard Library Headers
+////////////////////////////////////////////////////////////
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////
+//  Values
+//   - A declaration's value is parsed once, when the sheet
+//     is parsed, into a small tree of ValueRecords kept in
+//     Stylesheet::Values.  The parser reads the tokens the
+//     sheet already has for the value (Tokenizer.h).  Reading a number, a color or a
+//     keyword back out of it is a load, not a parse
+//   - The tree is flattened in pre-order: a function or
+//     list is followed by its children, and Size says how
+//     many records its whole subtree takes, so the next
+//     sibling of any record is at Index + Size
+//   - Commas separate a list's (or a function's) items;
+//     whitespace separates the parts of one item.  A
+//     value with commas is a comma List of items, an item
+//     with more than one part is a space List of parts,
+//     and a single part is stored as itself
+//   - Keywords and function names are ASCII case
+//     insensitive, so they are interned in lower case.
+//     Numbers keep their unit as a UnitId (Units.h) in
+//     the record itself
+//   - Hex colors, named colors and the rgb()/hsl()
+//     functions are turned into Colors (Colors.h)
+//   - Anything the parser doesn't understand is still
+//     kept, as a Delimiter (single characters like '/' or
+//     '!') or, failing that, the whole value as Raw text.
+//     Blocks ([], {} and bare ()), at-keywords and broken
+//     strings or urls make a value Raw.
+//     Every record keeps its source text either way
+//
+//     css::ValueView Width = sheet.ValueOf(Declaration);
+//     if (Width.Unit() == css::UnitId::Px)
+//       use(Width.Number());
+//
+////////////////////////////////////////////////////////////
+
+namespace css
+{
+
+  class Stylesheet;
+
+  /* A piece of Stylesheet::Text */
+  struct TextRef
+  {
+    std::uint32_t Offset = 0;
+    std::uint32_t Length = 0;
+  };
+
+  enum class ValueKind : std::uint8_t
+  {
+    None,        // the value was empty
+    Keyword,     // Data is the lower case name's atom
+    Number,      // Data is UnitId::None
+    Percentage,  // Number is the percentage, so 50% is 50.  Data is UnitId::Percent
+    Dimension,   // Data is the UnitId (Units.h)
+    Color,       // Data is the color, packed as 0xRRGGBBAA (Colors.h)
+    String,      // Text is the string without its quotes
+    Function,    // Data is the lower case name's atom, children are its arguments
+    List,        // children are its items
+    Delimiter,   // Data is the character
+    Raw          // couldn't be parsed; only Text is set
+  };
+
+  enum ValueFlags : std::uint8_t
+  {
+    CommaSeparated = 1 << 0   // a List whose items were separated by commas
+  };
+
+  struct ValueRecord
+  {
+    ValueKind     Kind = ValueKind::None;
+    std::uint8_t  Flags = 0;
+    std::uint16_t Count = 0;   // children, for functions and lists
+    std::uint32_t Size = 1;    // records in this value's subtree, itself included
+    float         Number = 0;
+    std::uint32_t Data = 0;
+    TextRef       Text;
+  };
+
+  /* Parses a declaration's value tokens into a sheet's value table */
+  class ValueParser
+  {
+  public:
+
+    ValueParser(std::pmr::vector<ValueRecord> &Values, AtomTable &Atoms);
+
+    /* Appends the records for the tokens [First, Last) and returns the index of its root.
+       The tokens point into Text, and their text (from First to the end of Last[-1]) has
+       been copied to Stored in the sheet's Text, so records can refer to pieces of it */
+    std::uint32_t Parse(const Token *First, const Token *Last, std::string_view Text, TextRef Stored);
+
+  private:
+
+    /* Items separated by commas, up to Last or an unmatched ')' */
+    bool ParseItems(std::size_t &Count, bool &Commas);
+    /* Parts separated by whitespace, up to a ',' or ')' */
+    bool ParseItem();
+    bool ParsePart();
+    bool ParseFunction();
+
+    /* Makes the records from First on the children of a new List at First */
+    void WrapList(std::size_t First, std::size_t Count, std::uint8_t Flags, std::uint32_t Start, std::uint32_t Stop);
+
+    void Push(ValueKind Kind, std::uint32_t Data, const Token &From);
+    Atom InternFolded(std::string_view Name);
+    TextRef RefTo(std::uint32_t Start, std::uint32_t Stop) const;
+    std::string_view TextOf(const Token &Of) const { return Source.substr(Of.Offset, Of.Length); }
+    void SkipWhitespace();
+
+    std::pmr::vector<ValueRecord> &Values;
+    AtomTable                     &Atoms;
+    std::string                    Folded;
+    std::string_view               Source;
+    const Token                   *Pos = nullptr, *End = nullptr;
+    std::uint32_t                  Shift = 0;  // from a Source offset to a Text offset
+  };
+
+  /* Read access to one parsed value */
+  class ValueView
+  {
+  public:
+
+    ValueView() = default;
+    ValueView(const Stylesheet &Sheet, std::uint32_t Index) : Sheet(&Sheet), Index(Index) { }
+
+    ValueKind Kind() const;
+    float Number() const;
+    UnitId Unit() const;
+    std::uint32_t Color() const;
+
+    /* The keyword, the function's name or the dimension's unit */
+    std::string_view Name() const;
+
+    /* The value's source text */
+    std::string_view Text() const;
+
+    /* Children of a function or list */
+    std::size_t Count() const;
+    ValueView Child(std::size_t Position) const;
+
+    bool IsComma() const;
+
+    explicit operator bool() const { return Sheet != nullptr; }
+
+  private:
+
+    const ValueRecord& Record() const;
+
+    const Stylesheet *Sheet = nullptr;
+    std::uint32_t     Index = 0;
+  };
+
+}